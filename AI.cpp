@@ -1,8 +1,17 @@
 #include <array>
 #include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <unistd.h>
+#include <fstream>
 #include <iostream>
 #include <vector>
 #include <map>
+#include <stdexcept>
+#include <new>
 #include <algorithm>
 
 using namespace std;
@@ -13,7 +22,7 @@ using namespace std;
 struct Point {
     int x{-1}, y{-1};
 
-    int distance(const Point& oth) { return abs(x - oth.x) + abs(y - oth.y); }
+    int distance(const Point& oth) const { return abs(x - oth.x) + abs(y - oth.y); }
     ostream& dump(ostream& ioOut) const {
         ioOut << x << " " << y;
         return ioOut;
@@ -21,35 +30,533 @@ struct Point {
 };
 ostream& operator<<(ostream& ioOut, const Point& obj) { return obj.dump(ioOut); }
 
+//----------------------------------Profiler----------------------------------------------------------
+// build with -DAI_PROFILE, every PROFILE_ macro is empty in submission builds;
+// -DAI_ALLOC adds the heap calls of every phase, single threaded tools only like the timings
+#if defined(AI_ALLOC) && !defined(AI_PROFILE)
+#define AI_PROFILE
+#endif
+#ifdef AI_PROFILE
+enum class Phase : int { TURN = 0, ORE_ANALYSIS, ENEMY_ANALYSIS, RADAR_SCORE, ROBOT_DECISION, KAMIKAZE,
+                         NEW_DIG_POINT, NEW_TRAP_POINT, NEW_RADAR_POINT, MOVE_BACK, SET_MOVE_POINT, PLAN_SEARCH, COUNT };
+enum class Counter : int { IS_SAFETY = 0, SAFETY_BUILD, SAFETY_PATCH, CHAIN_ADD, CHAIN_REBUILD, CHAIN_MEMBERS, ADDITIONAL_RADAR_SCORE,
+                           CHECK_EXPLOSION, DISTANCE_BUILD, COUNT };
+
+struct Profiler {
+    static constexpr int PHASES = (int)Phase::COUNT;
+    static constexpr int COUNTERS = (int)Counter::COUNT;
+    static const array<string, PHASES> LABELS_PHASES;
+    static const array<string, COUNTERS> LABELS_COUNTERS;
+
+    // innermost open phase of the thread, -1 outside getActions
+    static inline thread_local int openPhase = -1;
+
+    // this turn, helper phases add up every call
+    array<double, PHASES> phaseUs{};
+    array<long long, COUNTERS> counts{};
+    // one sample per turn over the match
+    array<vector<double>, PHASES> phaseSamples;
+    array<vector<double>, COUNTERS> countSamples;
+    vector<int> turnSamples;  // game turn of every sample
+
+    void count(Counter counter) { counts.at((int)counter)++; }
+    void endTurn(int turn) {
+        for (int i = 0; i < PHASES; i++) phaseSamples.at(i).push_back(phaseUs.at(i));
+        for (int i = 0; i < COUNTERS; i++) countSamples.at(i).push_back(counts.at(i));
+        turnSamples.push_back(turn);
+        phaseUs.fill(0);
+        counts.fill(0);
+#ifdef AI_ALLOC
+        for (int i = 0; i < PHASES; i++) {
+            for (int k = 0; k < HEAP_COLUMNS; k++) heapSamples.at(i).at(k).push_back(heap.at(i).at(k));
+        }
+        for (auto& row : heap) row.fill(0);
+#endif
+    }
+#ifdef AI_ALLOC
+    // allocations, frees, bytes allocated; charged to the innermost phase and to the turn
+    static constexpr int HEAP_COLUMNS = 3;
+    static const array<string, HEAP_COLUMNS> LABELS_HEAP;
+    array<array<long long, HEAP_COLUMNS>, PHASES> heap{};
+    array<array<vector<double>, HEAP_COLUMNS>, PHASES> heapSamples;
+
+    void countHeap(int column, long long amount) {
+        if (openPhase == -1) return;
+        heap.at(openPhase).at(column) += amount;
+        if (openPhase != (int)Phase::TURN) heap.at((int)Phase::TURN).at(column) += amount;
+    }
+    // most allocations of a turn from fromTurn on, the first turns fill the buffers kept for the game
+    long long steadyAllocs(int fromTurn) const {
+        double most = 0;
+        const vector<double>& allocs = heapSamples.at((int)Phase::TURN).at(0);
+        for (size_t t = 0; t < allocs.size(); t++) {
+            if (turnSamples.at(t) >= fromTurn) most = max(most, allocs.at(t));
+        }
+        return (long long)most;
+    }
+#endif
+    static void dumpRow(ostream& ioOut, const string& label, vector<double> v) {
+        if (v.empty()) return;
+        sort(v.begin(), v.end());
+        ioOut << label << "\tp50 " << v.at(v.size() / 2) << "\tp99 " << v.at(v.size() * 99 / 100) << "\tmax " << v.back() << "\n";
+    }
+    void dump(ostream& ioOut) const {
+        ioOut << "---- profile over " << phaseSamples.at(0).size() << " turns, phase us/turn ----\n";
+        for (int i = 0; i < PHASES; i++) dumpRow(ioOut, LABELS_PHASES.at(i), phaseSamples.at(i));
+        ioOut << "---- calls/turn ----\n";
+        for (int i = 0; i < COUNTERS; i++) dumpRow(ioOut, LABELS_COUNTERS.at(i), countSamples.at(i));
+#ifdef AI_ALLOC
+        // phases that never touched the heap are left out
+        for (int k = 0; k < HEAP_COLUMNS; k++) {
+            ioOut << "---- heap " << LABELS_HEAP.at(k) << "/turn ----\n";
+            for (int i = 0; i < PHASES; i++) {
+                const vector<double>& v = heapSamples.at(i).at(k);
+                if (i == (int)Phase::TURN || any_of(v.begin(), v.end(), [](double x) { return x > 0; }))
+                    dumpRow(ioOut, LABELS_PHASES.at(i), v);
+            }
+        }
+#endif
+    }
+};
+const array<string, Profiler::PHASES> Profiler::LABELS_PHASES{"Turn", "OreAnalysis", "EnemyAnalysis", "RadarScore", "RobotDecision",
+    "Kamikaze", "NewDigPoint", "NewTrapPoint", "NewRadarPoint", "MoveBack", "SetMovePoint", "PlanSearch"};
+const array<string, Profiler::COUNTERS> Profiler::LABELS_COUNTERS{"IsSafety", "SafetyBuild", "SafetyPatch", "ChainAdd",
+    "ChainRebuild", "ChainMembers", "AdditionalRadarScore", "CheckExplosion", "DistanceBuild"};
+#ifdef AI_ALLOC
+const array<string, Profiler::HEAP_COLUMNS> Profiler::LABELS_HEAP{"allocs", "frees", "bytes"};
+#endif
+
+Profiler profiler;
+
+// time spent until end of scope goes to phase, it is the open phase meanwhile
+struct ScopedTimer {
+    Phase phase;
+    chrono::steady_clock::time_point start{chrono::steady_clock::now()};
+    bool running{true};
+    int outer{Profiler::openPhase};
+
+    explicit ScopedTimer(Phase _phase) : phase{_phase} { Profiler::openPhase = (int)phase; }
+    ~ScopedTimer() { stop(); }
+    void stop() {
+        if (!running) return;
+        profiler.phaseUs.at((int)phase) += chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+        Profiler::openPhase = outer;
+        running = false;
+    }
+    // close current phase and open the next one
+    void next(Phase _phase) {
+        stop();
+        phase = _phase;
+        Profiler::openPhase = (int)phase;
+        start = chrono::steady_clock::now();
+        running = true;
+    }
+};
+
+// whole getActions, switch between sequential phases and close the turn sample
+struct TurnTimer {
+    int gameTurn;
+    ScopedTimer turn{Phase::TURN};
+    ScopedTimer phase{Phase::ORE_ANALYSIS};
+
+    explicit TurnTimer(int _gameTurn) : gameTurn{_gameTurn} {}
+    ~TurnTimer() {
+        phase.stop();
+        turn.stop();
+        profiler.endTurn(gameTurn);
+    }
+};
+
+#ifdef AI_ALLOC
+// every heap call of the program, counted while a phase is open
+void* operator new(size_t bytes) {
+    profiler.countHeap(0, 1);
+    profiler.countHeap(2, bytes);
+    if (void* p = malloc(bytes ? bytes : 1)) return p;
+    throw bad_alloc();
+}
+void* operator new[](size_t bytes) { return operator new(bytes); }
+void operator delete(void* p) noexcept {
+    if (p) profiler.countHeap(1, 1);
+    free(p);
+}
+void operator delete[](void* p) noexcept { operator delete(p); }
+void operator delete(void* p, size_t) noexcept { operator delete(p); }
+void operator delete[](void* p, size_t) noexcept { operator delete(p); }
+#endif
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(phase) ScopedTimer PROFILE_CONCAT(profileTimer, __LINE__){phase}
+#define PROFILE_TURN(turn) TurnTimer profileTurn{turn}
+#define PROFILE_PHASE(_phase) profileTurn.phase.next(_phase)
+#define PROFILE_COUNT(counter) profiler.count(counter)
+#define PROFILE_DUMP() profiler.dump(cerr)
+#else
+#define PROFILE_SCOPE(phase)
+#define PROFILE_TURN(turn)
+#define PROFILE_PHASE(phase)
+#define PROFILE_COUNT(counter)
+#define PROFILE_DUMP()
+#endif
+
 //*********************************  GAME STATE  **********************************************
 
 //----------------------------------Constants----------------------------------------------------------
 enum class Type : int { NONE = 0, ROBOT, RADAR, TRAP, ORE, HOLE };
 enum class ActionType : int { WAIT = 0, MOVE, DIG, REQUEST };
+// robot speech bubble, also read back as the robot state on the next turn
+enum class Message : int8_t { NONE = 0, READY, OTW, OTW_RADAR, OTW_TRAP, OTW_HOLE, OTW_KAMIKAZE, OTW_LEFT4DEAD, DIG_TRAP, DESTROY, KAMIKAZE, SYNC_ATTACK, GO_HOME, GO_HOME_URGENT, WAIT_HOME, EVADE, GIMME_RADAR, GIMME_TRAP, GIMME_HOLE, DREAMING, DEAD };
 
 static constexpr int MAX_PLAYERS = 2;
 static constexpr int MAX_WIDTH = 30;
 static constexpr int MAX_HEIGHT = 15;
 static constexpr int MAX_ROBOTS = 5;
+static constexpr int MAX_TURNS = 200;
+
+// rules
+static constexpr int ITEM_COOLDOWN = 5;
+static constexpr int RADAR_RANGE = 4;
+static constexpr int MOVE_RANGE = 4;
+static constexpr int DIG_RANGE = 1;
+static constexpr int TRAP_RANGE = 1;
+// map generation, ore veins are diamonds of ORE_VEIN_RANGE centered from column ORE_VEIN_MIN_X
+static constexpr double ORE_VEIN_DENSITY_MIN = 0.032;  // veins per cell
+static constexpr double ORE_VEIN_DENSITY_MAX = 0.064;
+static constexpr int ORE_VEIN_RANGE = 2;
+static constexpr int ORE_VEIN_MIN_X = 4;
+static constexpr int MAX_ORE = 3;
+
+//----------------------------------Bitboard----------------------------------------------------------
+// one bit per cell, index y * MAX_WIDTH + x so bit order is the row by row scan order
+struct Bitboard {
+    static constexpr int WORDS = (MAX_WIDTH * MAX_HEIGHT + 63) / 64;
+    array<uint64_t, WORDS> w{};
+
+    static constexpr int index(int x, int y) { return y * MAX_WIDTH + x; }
+    static bool inside(int x, int y) { return x >= 0 && x < MAX_WIDTH && y >= 0 && y < MAX_HEIGHT; }
+
+    bool test(int x, int y) const {
+        if (!inside(x, y)) return false;
+        int i = index(x, y);
+        return (w[i / 64] >> (i % 64)) & 1;
+    }
+    bool test(Point p) const { return test(p.x, p.y); }
+    void set(int x, int y, bool value = true) {
+        if (!inside(x, y)) return;
+        int i = index(x, y);
+        if (value) w[i / 64] |= 1ULL << (i % 64);
+        else w[i / 64] &= ~(1ULL << (i % 64));
+    }
+    void set(Point p, bool value = true) { set(p.x, p.y, value); }
+    void reset(Point p) { set(p.x, p.y, false); }
+    void clear() { w.fill(0); }
+
+    int count() const {
+        int n = 0;
+        for (uint64_t v : w) n += __builtin_popcountll(v);
+        return n;
+    }
+    bool any() const {
+        for (uint64_t v : w) {
+            if (v) return true;
+        }
+        return false;
+    }
+
+    Bitboard operator&(const Bitboard& oth) const { Bitboard r; for (int i = 0; i < WORDS; i++) r.w[i] = w[i] & oth.w[i]; return r; }
+    Bitboard operator|(const Bitboard& oth) const { Bitboard r; for (int i = 0; i < WORDS; i++) r.w[i] = w[i] | oth.w[i]; return r; }
+    // this & ~oth
+    Bitboard andNot(const Bitboard& oth) const { Bitboard r; for (int i = 0; i < WORDS; i++) r.w[i] = w[i] & ~oth.w[i]; return r; }
+    Bitboard operator~() const { return full().andNot(*this); }
+    bool operator==(const Bitboard& oth) const { return w == oth.w; }
+
+    // move every bit n index up (n > 0) or down (n < 0), bits leaving the board are dropped
+    Bitboard shifted(int n) const {
+        Bitboard r;
+        int ws = abs(n) / 64, bs = abs(n) % 64;
+        for (int i = 0; i < WORDS; i++) {
+            int src = n >= 0 ? i - ws : i + ws;
+            if (src < 0 || src >= WORDS) continue;
+            if (n >= 0) {
+                r.w[i] = w[src] << bs;
+                if (bs && src > 0) r.w[i] |= w[src - 1] >> (64 - bs);
+            }
+            else {
+                r.w[i] = w[src] >> bs;
+                if (bs && src + 1 < WORDS) r.w[i] |= w[src + 1] << (64 - bs);
+            }
+        }
+        return r & full();
+    }
+    // every cell within manhattan radius of a set cell
+    Bitboard dilate(int radius) const {
+        Bitboard r = *this;
+        for (int k = 0; k < radius; k++) {
+            r = r | r.shifted(1).andNot(column(0)) | r.shifted(-1).andNot(column(MAX_WIDTH - 1)) | r.shifted(MAX_WIDTH) | r.shifted(-MAX_WIDTH);
+        }
+        return r;
+    }
+
+    template <class F>
+    void forEach(F f) const {
+        for (int i = 0; i < WORDS; i++) {
+            for (uint64_t v = w[i]; v; v &= v - 1) {
+                int bit = i * 64 + __builtin_ctzll(v);
+                f(Point{bit % MAX_WIDTH, bit / MAX_WIDTH});
+            }
+        }
+    }
+
+    static Bitboard fromPoints(const vector<Point>& points) {
+        Bitboard r;
+        for (const Point& p : points) r.set(p);
+        return r;
+    }
+    static const Bitboard& full() {
+        static const Bitboard board = [] {
+            Bitboard r;
+            for (int i = 0; i < MAX_WIDTH * MAX_HEIGHT; i++) r.w[i / 64] |= 1ULL << (i % 64);
+            return r;
+        }();
+        return board;
+    }
+    static const Bitboard& column(int x) {
+        static const array<Bitboard, MAX_WIDTH> columns = [] {
+            array<Bitboard, MAX_WIDTH> r;
+            for (int _x = 0; _x < MAX_WIDTH; _x++) {
+                for (int y = 0; y < MAX_HEIGHT; y++) r.at(_x).set(_x, y);
+            }
+            return r;
+        }();
+        return columns.at(x);
+    }
+    // every cell out of base
+    static const Bitboard& field() {
+        static const Bitboard board = full().andNot(column(0));
+        return board;
+    }
+    // column x, rows [y0, y1[
+    static Bitboard segment(int x, int y0, int y1) {
+        Bitboard r;
+        for (int y = y0; y < y1; y++) r.set(x, y);
+        return r;
+    }
+};
+
+//----------------------------------CellRegistry----------------------------------------------------------
+// why a cell went into a registry
+enum class Reason : int8_t { NONE = 0, NEW_HOLE, ORE_REDUCE, ENEMY_STOP };
+
+// set of cells, O(1) insert/remove/test, iterate in insertion order, no allocation
+struct CellRegistry {
+    static constexpr int CELLS = MAX_WIDTH * MAX_HEIGHT;
+    static constexpr int16_t END = -1;
+
+    Bitboard mask;
+    // linked list through cell index, insertion order
+    array<int16_t, CELLS> prev{};
+    array<int16_t, CELLS> next{};
+    int16_t head{END}, tail{END};
+    int count{0};
+    // metadata of each entry
+    array<int16_t, CELLS> turn{};  // first suspected
+    array<Reason, CELLS> reason{};
+
+    static Point point(int i) { return Point{i % MAX_WIDTH, i / MAX_WIDTH}; }
+
+    bool contains(Point p) const { return mask.test(p); }
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+    int firstTurn(Point p) const { return turn.at(Bitboard::index(p.x, p.y)); }
+    Reason why(Point p) const { return reason.at(Bitboard::index(p.x, p.y)); }
+
+    // false if already there, first metadata is kept
+    bool insert(Point p, int _turn = 0, Reason _reason = Reason::NONE) {
+        if (!Bitboard::inside(p.x, p.y) || mask.test(p)) return false;
+        int16_t i = Bitboard::index(p.x, p.y);
+        mask.set(p);
+        prev.at(i) = tail;
+        next.at(i) = END;
+        if (tail != END) next.at(tail) = i;
+        else head = i;
+        tail = i;
+        turn.at(i) = _turn;
+        reason.at(i) = _reason;
+        count++;
+        return true;
+    }
+    bool remove(Point p) {
+        if (!mask.test(p)) return false;
+        int16_t i = Bitboard::index(p.x, p.y);
+        mask.reset(p);
+        if (prev.at(i) != END) next.at(prev.at(i)) = next.at(i);
+        else head = next.at(i);
+        if (next.at(i) != END) prev.at(next.at(i)) = prev.at(i);
+        else tail = prev.at(i);
+        count--;
+        return true;
+    }
+    void clear() {
+        mask.clear();
+        head = tail = END;
+        count = 0;
+    }
+
+    struct Iterator {
+        const CellRegistry* registry;
+        int16_t i;
+        Point operator*() const { return point(i); }
+        Iterator& operator++() {
+            i = registry->next.at(i);
+            return *this;
+        }
+        bool operator!=(const Iterator& oth) const { return i != oth.i; }
+    };
+    Iterator begin() const { return Iterator{this, head}; }
+    Iterator end() const { return Iterator{this, END}; }
+};
+
+//----------------------------------ChainIndex----------------------------------------------------------
+// connected components of adjacent cells (trap chains), union find with a circular member list per component
+struct ChainIndex {
+    static constexpr int CELLS = MAX_WIDTH * MAX_HEIGHT;
+    static constexpr int NEIGHBOURS = 5;  // a cell and its 4 adjacent cells
+
+    Bitboard members;
+    array<int16_t, CELLS> parent{};
+    array<int16_t, CELLS> next{};  // next member of the same component
+    array<int16_t, CELLS> size{};
+
+    int find(int i) {
+        while (parent.at(i) != i) {
+            parent.at(i) = parent.at(parent.at(i));
+            i = parent.at(i);
+        }
+        return i;
+    }
+    // component of p, -1 if p is not a member
+    int root(Point p) {
+        if (!members.test(p)) return -1;
+        return find(Bitboard::index(p.x, p.y));
+    }
+    void unite(int a, int b) {
+        int ra = find(a), rb = find(b);
+        if (ra == rb) return;
+        if (size.at(ra) < size.at(rb)) swap(ra, rb);
+        parent.at(rb) = ra;
+        size.at(ra) += size.at(rb);
+        // splice the two member cycles
+        swap(next.at(a), next.at(b));
+    }
+    void add(Point p) {
+        if (!Bitboard::inside(p.x, p.y) || members.test(p)) return;
+        PROFILE_COUNT(Counter::CHAIN_ADD);
+        int i = Bitboard::index(p.x, p.y);
+        members.set(p);
+        parent.at(i) = i;
+        next.at(i) = i;
+        size.at(i) = 1;
+        for (Point q : {Point{p.x - 1, p.y}, Point{p.x + 1, p.y}, Point{p.x, p.y - 1}, Point{p.x, p.y + 1}}) {
+            if (members.test(q)) unite(i, Bitboard::index(q.x, q.y));
+        }
+    }
+    // union find can not split, rebuild on removal
+    void rebuild(const Bitboard& cells) {
+        PROFILE_COUNT(Counter::CHAIN_REBUILD);
+        members.clear();
+        cells.forEach([&](Point p) { add(p); });
+    }
+    void remove(Point p) {
+        if (!members.test(p)) return;
+        Bitboard cells = members;
+        cells.reset(p);
+        rebuild(cells);
+    }
+    // follow a mask that is re-sent every turn
+    void sync(const Bitboard& cells) {
+        if (members.andNot(cells).any()) rebuild(cells);
+        else cells.andNot(members).forEach([&](Point p) { add(p); });
+    }
+    // distinct components on p or next to it
+    int touching(Point p, array<int, NEIGHBOURS>& roots) {
+        int count = 0;
+        for (Point q : {p, Point{p.x - 1, p.y}, Point{p.x + 1, p.y}, Point{p.x, p.y - 1}, Point{p.x, p.y + 1}}) {
+            int r = root(q);
+            if (r != -1 && std::find(roots.begin(), roots.begin() + count, r) == roots.begin() + count) {
+                roots.at(count++) = r;
+            }
+        }
+        return count;
+    }
+    template <class F>
+    void forEachMember(int r, F f) {
+        int i = r;
+        do {
+            f(Point{i % MAX_WIDTH, i / MAX_WIDTH});
+            i = next.at(i);
+        } while (i != r);
+    }
+    // cells hit when the component explode
+    Bitboard blast(int r) {
+        Bitboard cells;
+        forEachMember(r, [&](Point p) { cells.set(p); });
+        return cells.dilate(1);
+    }
+};
 
 //----------------------------------Cell----------------------------------------------------------
-struct Cell : Point {
-    bool hole{false};
-    bool oreVisible{false};
-    int ore{-1};
-    int score{0};
-    
-    void update(Point p, int _ore, bool _oreVisible, int _hole) {
+// one cell of a Grid, every field reads and writes its plane
+struct Cell {
+    // a bit of the flags plane, reads and assigns like a bool
+    struct Flag {
+        uint8_t& flags;
+        uint8_t bit;
+        operator bool() const { return flags & bit; }
+        Flag& operator=(bool on) {
+            flags = on ? flags | bit : flags & ~bit;
+            return *this;
+        }
+    };
+
+    int8_t& ore;
+    Flag hole;
+    Flag oreVisible;
+    int16_t& score;
+    int8_t& unknown; // undiscover + no visibility cells in radar range, kept by Game::updateCell
+
+    void update(int _ore, bool _oreVisible, int _hole) {
         hole = _hole;
         if(_oreVisible){
             ore = _ore;
         }
         oreVisible = _oreVisible;
-        x = p.x;
-        y = p.y;
     }
 };
 
+//----------------------------------Grid----------------------------------------------------------
+// the board as planes in Bitboard::index order, a byte a cell but the score;
+// get() is bounds checked like the old nested arrays, hot loops index the planes directly
+struct Grid {
+    static constexpr int CELLS = MAX_WIDTH * MAX_HEIGHT;
+    static constexpr uint8_t HOLE = 1;
+    static constexpr uint8_t ORE_VISIBLE = 2;
+
+    array<int8_t, CELLS> ore; // -1 until seen
+    array<uint8_t, CELLS> flags{};
+    array<int16_t, CELLS> score{};
+    array<int8_t, CELLS> unknown{};
+
+    Grid() { ore.fill(-1); }
+    Cell get(int x, int y) {
+        if(!Bitboard::inside(x, y)) throw out_of_range("Grid::get");
+        return (*this)[Bitboard::index(x, y)];
+    }
+    Cell get(Point p) { return get(p.x, p.y); }
+    // unchecked
+    Cell operator[](int i) { return Cell{ore[i], {flags[i], HOLE}, {flags[i], ORE_VISIBLE}, score[i], unknown[i]}; }
+};
+
 //----------------------------------Entity----------------------------------------------------------
 struct Entity : Point {
     int id{0};
@@ -98,85 +605,322 @@ struct Player {
     }
 };
 
-//----------------------------------Game----------------------------------------------------------
-// global variable
-vector<Point> dangerPointList; // danger list dont ever go there
-vector<Point> holePointList; // danger list dont ever go there
+//----------------------------------Params----------------------------------------------------------
+// strategy constants, loaded at startup or set by a tuner; the defaults here are the compiled-in set
+struct Params {
+    float radarKeep{0.95f};   // radar candidates within this share of the best radar score
+    float blindKeep{0.90f};   // blind digs within this share of the best expected ore
+    int radarUrgentOre{10};   // safe ore cells left when a radar gets urgent
+    int radarEnoughOre{20};   // safe ore cells above which no radar is needed
+    int maxTraps{10};         // traps of ours on the board before trap and fake missions stop
+    int trapMinRobots{2};     // trap and fake missions need more robots alive than this
+    int fakeCooldown{5};      // turns between fake holes
+    int noMineTurn{10};       // turn the enemy is judged on its danger points
+    int noMineDangers{2};     // danger points up to this, the enemy does not lay traps
+    int radarScorePeak{4};    // static radar score of a cell, peak less 1 per step in radar range
+
+    // every field with the range a tuner may move it in
+    template <class F>
+    void forEach(F f){
+        f("radarKeep", radarKeep, 0.7, 1.0);
+        f("blindKeep", blindKeep, 0.5, 1.0);
+        f("radarUrgentOre", radarUrgentOre, 0, 30);
+        f("radarEnoughOre", radarEnoughOre, 5, 60);
+        f("maxTraps", maxTraps, 0, 30);
+        f("trapMinRobots", trapMinRobots, 0, 5);
+        f("fakeCooldown", fakeCooldown, 1, 20);
+        f("noMineTurn", noMineTurn, 3, 40);
+        f("noMineDangers", noMineDangers, 0, 10);
+        f("radarScorePeak", radarScorePeak, 4, 12);
+    }
+    // "name value" per line, names it does not know are skipped
+    void load(istream& in){
+        string name;
+        double value;
+        while(in >> name >> value){
+            forEach([&](const char* field, auto& param, double, double){
+                if(name == field) param = value;
+            });
+        }
+    }
+    void save(ostream& out){
+        forEach([&](const char* field, auto& param, double, double){ out << field << " " << param << "\n"; });
+    }
+};
+
+//----------------------------------Arena----------------------------------------------------------
+// bump allocator for the scratch containers of the decision helpers, rewound at Game::reset;
+// a full arena falls back to the heap so an unusual turn only costs speed
+struct Arena {
+    static constexpr size_t BYTES = 1 << 16;
+    alignas(alignof(max_align_t)) array<unsigned char, BYTES> buffer;
+    size_t used{0};
+    size_t peak{0};  // high water mark over the game
+    int overflows{0};  // heap fallbacks over the game
+
+    Arena() = default;
+    // a copied game starts with an empty arena, scratch never outlives a turn
+    Arena(const Arena&) {}
+    Arena& operator=(const Arena&) { return *this; }
+
+    void* allocate(size_t bytes, size_t align){
+        size_t begin = (used + align - 1) & ~(align - 1);
+        if(begin + bytes > BYTES){
+            overflows++;
+            return ::operator new(bytes);
+        }
+        used = begin + bytes;
+        peak = max(peak, used);
+        return buffer.data() + begin;
+    }
+    void deallocate(void* p){
+        if(!owns(p)) ::operator delete(p);
+    }
+    bool owns(const void* p) const {
+        auto* byte = static_cast<const unsigned char*>(p);
+        return byte >= buffer.data() && byte < buffer.data() + BYTES;
+    }
+    void rewind() { used = 0; }
+
+    // gives back everything allocated while alive, declare it before the containers it reclaims
+    // and never return one of them out of its function
+    struct Scope {
+        Arena& arena;
+        size_t mark;
+        explicit Scope(Arena& _arena) : arena(_arena), mark(_arena.used) {}
+        ~Scope() { arena.used = mark; }
+    };
+};
+
+template <class T>
+struct ArenaAllocator {
+    using value_type = T;
+    Arena* arena;
+
+    ArenaAllocator(Arena& _arena) : arena(&_arena) {}
+    template <class U>
+    ArenaAllocator(const ArenaAllocator<U>& oth) : arena(oth.arena) {}
+    T* allocate(size_t n) { return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T))); }
+    void deallocate(T* p, size_t) { arena->deallocate(p); }
+    template <class U>
+    bool operator==(const ArenaAllocator<U>& oth) const { return arena == oth.arena; }
+    template <class U>
+    bool operator!=(const ArenaAllocator<U>& oth) const { return arena != oth.arena; }
+};
+
+// per-turn vector, Scratch<Point> list{game.arena};
+template <class T>
+using Scratch = vector<T, ArenaAllocator<T>>;
+
+//----------------------------------Diamond----------------------------------------------------------
+// offsets within manhattan radius R, x major then y like the 9x9 box scans they replace
+template <int R>
+struct Diamond {
+    static constexpr int SIZE = 2 * R * (R + 1) + 1;
+    array<int8_t, SIZE> dx{};
+    array<int8_t, SIZE> dy{};
+    array<int8_t, SIZE> dist{};
+    array<int8_t, 2 * R + 1> center{};  // offset of dy = 0 in every column dx = -R..R
+
+    constexpr Diamond() {
+        int k = 0;
+        for(int x = -R; x <= R; x++){
+            int half = R - (x < 0 ? -x : x);
+            center[x + R] = k + half;
+            for(int y = -half; y <= half; y++){
+                dx[k] = x;
+                dy[k] = y;
+                dist[k] = (x < 0 ? -x : x) + (y < 0 ? -y : y);
+                k++;
+            }
+        }
+    }
+    // f(cell, distance) for the cells around p on the board from column minX, clipped a column at a time
+    template <class F>
+    void forEachClipped(Point p, int minX, F f) const {
+        for(int x = max(-R, minX - p.x); x <= min(R, MAX_WIDTH - 1 - p.x); x++){
+            int half = R - abs(x);
+            int k = center[x + R];
+            for(int y = max(-half, -p.y); y <= min(half, MAX_HEIGHT - 1 - p.y); y++)
+                f(Point{p.x + x, p.y + y}, dist[k + y]);
+        }
+    }
+};
+template <int R>
+constexpr Diamond<R> DIAMOND{};
+
+// radar range of every cell out of base over the cells out of base, the initial score and unknown
+// fields are linear in it so the whole field is baked in at compile time
+struct RadarField {
+    array<int16_t, Grid::CELLS> cells{};     // in range
+    array<int16_t, Grid::CELLS> distance{};  // summed distance to them
+
+    constexpr RadarField() {
+        const Diamond<RADAR_RANGE>& diamond = DIAMOND<RADAR_RANGE>;
+        for(int x = 1; x < MAX_WIDTH; x++){
+            for(int y = 0; y < MAX_HEIGHT; y++){
+                int i = Bitboard::index(x, y);
+                for(int k = 0; k < diamond.SIZE; k++){
+                    int qx = x + diamond.dx[k], qy = y + diamond.dy[k];
+                    if(qx < 1 || qx >= MAX_WIDTH || qy < 0 || qy >= MAX_HEIGHT) continue;
+                    cells[i]++;
+                    distance[i] += diamond.dist[k];
+                }
+            }
+        }
+    }
+};
+constexpr RadarField RADAR_FIELD{};
 
-vector<bool> suspectID(MAX_ROBOTS, false); // suspicious for enemy robot spend 1 turn at home
+//----------------------------------TurnEvent----------------------------------------------------------
+// what changed since last turn. updateCell/updateEntity emit the cell and entity events as the input comes
+// in, ClassifyEvents tags them ours or enemy and adds the robot events once at the start of getActions
+enum class Event : int8_t {
+    CELL_CHANGED,     // ore reading, visibility or hole of p
+    ORE_REDUCED,      // visible ore of p went down
+    NEW_HOLE,         // p was dug for the first time
+    ROBOT_PAUSED,     // robot stayed on p
+    ROBOT_MOVED,      // robot went from from to p
+    ROBOT_HOME,       // robot came back to base, from out of it
+    ROBOT_DUG,        // our dig of p went through
+    ROBOT_LOST,       // robot was destroyed, last seen on from
+    ENTITY_APPEARED,  // radar or trap of ours on p
+    ENTITY_GONE,      // radar or trap of ours on p was dug up or blown
+};
+
+struct TurnEvent {
+    Event type{Event::CELL_CHANGED};
+    int8_t owner{-1};  // 0 ours, 1 enemy, -1 nobody's or not classified yet
+    int8_t robot{-1};
+    Type item{Type::NONE};  // RADAR or TRAP for entity events
+    Point p{};
+    Point from{};  // robot events, where it was last turn
+};
 
+//----------------------------------Game----------------------------------------------------------
 struct Game {
-    array<array<Cell, MAX_HEIGHT>, MAX_WIDTH> grid;
+    Grid grid;
     array<Player, MAX_PLAYERS> players;
     vector<Entity> radars;
     vector<Entity> traps;
     vector<Point> digPointList;
-    vector<Point> oreReduceList;
-    vector<Point> newHoleList;
+    vector<TurnEvent> events;  // this turn only
+    bool classified{false};    // events went through ClassifyEvents
     vector<vector<Point>> bombList;
+    // bit per cell, refreshed by updateCell/updateEntity
+    Bitboard holeMask;
+    Bitboard visibleMask;
+    Bitboard knownMask; // ore != -1
+    Bitboard oreMask; // visible ore > 0, same cells as digPointList
+    Bitboard radarMask;
+    Bitboard trapMask;
+    Bitboard lastRadarMask; // last turn's, for the entity events
+    Bitboard lastTrapMask;
+    ChainIndex trapChains; // synced with trapMask at start of getActions
+    Arena arena; // scratch of the decision helpers, one turn long
     int turn = -1;
     int fakeCD = 0;
+    int radarScorePeak = 4;  // of the Params initScore ran with, a new hole takes its score back
 
     Game() { reset(); }
-    Cell& get(int x, int y) { return grid.at(x).at(y); }
-    Cell& get(Point p) { return grid.at(p.x).at(p.y); }
+    Cell get(int x, int y) { return grid.get(x, y); }
+    Cell get(Point p) { return grid.get(p); }
     void reset() {
         if(fakeCD > 0) fakeCD--;
         turn++;
+        arena.rewind();
         radars.reserve(20);
         radars.clear();
+        lastRadarMask = radarMask;
+        lastTrapMask = trapMask;
+        radarMask.clear();
+        trapMask.clear();
         traps.reserve(30);
         traps.clear();
         digPointList.reserve(20);
         digPointList.clear();
-        // track ore reduced
-        oreReduceList.reserve(10);
-        oreReduceList.clear();
-        // track new hole
-        newHoleList.reserve(10);
-        newHoleList.clear();
+        // two events a cell, far beyond a real turn, so turns do not allocate
+        events.reserve(2 * Grid::CELLS);
+        events.clear();
+        classified = false;
+    }
+    void emit(Event type, Point p, Type item = Type::NONE) {
+        TurnEvent e;
+        e.type = type;
+        e.item = item;
+        e.p = p;
+        events.push_back(e);
+    }
+    // cells of the turn's events of type by owner
+    Bitboard eventCells(Event type, int owner) const {
+        Bitboard cells;
+        for(const TurnEvent& e : events){
+            if(e.type == type && e.owner == owner) cells.set(e.p);
+        }
+        return cells;
+    }
+    // weighted graph, radar placement score for every cell out of base, peak less 1 per step in radar range
+    // of the undug cells (updateCell takes a new hole's share back);
+    // a fresh grid knows nothing, every cell out of base adds 2 unknown (no ore reading, not visible) in its range
+    void initScore(const Params& params) {
+        radarScorePeak = params.radarScorePeak;
+        for(int i = 0; i < Grid::CELLS; i++){
+            grid.score[i] = radarScorePeak * RADAR_FIELD.cells[i] - RADAR_FIELD.distance[i];
+            grid.unknown[i] = 2 * RADAR_FIELD.cells[i];
+        }
+    }
+    // radar placement value, static score + undiscover + no visibility in range; p on the board
+    int radarValue(Point p) {
+        int i = Bitboard::index(p.x, p.y);
+        return grid.score[i] + grid.unknown[i];
+    }
+    static int unknownWeight(const Cell& cell) { return (cell.ore == -1) + (cell.oreVisible == false); }
+    // add delta to unknown of every cell within radar range of p
+    void spreadUnknown(Point p, int delta) {
+        if(delta == 0 || p.x < 1) return;
+        DIAMOND<RADAR_RANGE>.forEachClipped(p, 1, [&](Point q, int){ grid.unknown[Bitboard::index(q.x, q.y)] += delta; });
     }
     void updateOre(int owner, int ore) { players.at(owner).updateOre(owner, ore); }
     void updateCooldown(int owner, int radar, int trap) { players.at(owner).updateCooldown(radar, trap); }
-    void updateCell(int x, int y, const string& ore, int hole) {
-        int oreAmount{-1};
+    void updateCell(int x, int y, int ore, int hole) {  // ore -1 for "?"
+        int oreAmount{ore};
         bool oreVisible{false};
         Point p{x, y};
+        Cell cell = get(p);
         // within radar
-        if (ore != "?") {
-            oreAmount = stoi(ore);
+        if (ore != -1) {
             oreVisible = true;
             // update available Tile
             if(oreAmount > 0){
                 digPointList.push_back(p);   
             }
             // someone digging this tile
-            if(get(p).ore != -1 && oreAmount < get(p).ore ){
+            if(cell.ore != -1 && oreAmount < cell.ore ){
                 // record this hole first for further analysis
-                oreReduceList.push_back(p);
+                emit(Event::ORE_REDUCED, p);
             }
         }
         
         // new hole
-        if(hole == 1 && get(p).hole == false){
-            // change score for radar placement
-            for(int _x = x-4; _x <= x+4; _x++){
-                for(int _y = y-4; _y <= y+4; _y++){
-                    if(_x < 1 || _x >= MAX_WIDTH) continue;
-                    if(_y < 0 || _y >= MAX_HEIGHT) continue;
-                    // for distance smaller than 5 valid point
-                    if(Point({x,y}).distance(Point({_x,_y})) < 5){
-                        // no hole score
-                        get(_x,_y).score -= 4 - Point({x,y}).distance(Point({_x,_y}));
-                    }
-                }
-            }
+        if(hole == 1 && cell.hole == false){
+            // change score for radar placement, no hole score: the share initScore gave every cell in range goes
+            DIAMOND<RADAR_RANGE>.forEachClipped(p, 1, [&](Point q, int distance){
+                grid.score[Bitboard::index(q.x, q.y)] -= radarScorePeak - distance;
+            });
             // if suspicious id around
             // record this hole first for further analysis
-            newHoleList.push_back(p);
+            emit(Event::NEW_HOLE, p);
         }
+        if(oreVisible != cell.oreVisible || (oreVisible && oreAmount != cell.ore) || (hole == 1) != cell.hole)
+            emit(Event::CELL_CHANGED, p);
         
-        get(p).update(p, oreAmount, oreVisible, hole);
+        int weight = unknownWeight(cell);
+        cell.update(oreAmount, oreVisible, hole);
+        spreadUnknown(p, unknownWeight(cell) - weight);
+        holeMask.set(p, cell.hole);
+        visibleMask.set(p, oreVisible);
+        knownMask.set(p, cell.ore != -1);
+        oreMask.set(p, oreVisible && oreAmount > 0);
     }
     void updateEntity(int id, int type, int x, int y, int _item) {
         // item
@@ -192,370 +936,1161 @@ struct Game {
         switch (type) {  // 0 for your robot, 1 for other robot, 2 for radar, 3 for trap
         case 0:
         case 1: players.at(type).updateRobot(id, p, item, type); break;
-        case 2: radars.emplace_back(id, Type::RADAR, p, item, 0); break;
-        case 3: traps.emplace_back(id, Type::TRAP, p, item, 0); break;
+        case 2:
+            radars.emplace_back(id, Type::RADAR, p, item, 0);
+            radarMask.set(p);
+            if(!lastRadarMask.test(p)) emit(Event::ENTITY_APPEARED, p, Type::RADAR);
+            break;
+        case 3:
+            traps.emplace_back(id, Type::TRAP, p, item, 0);
+            trapMask.set(p);
+            if(!lastTrapMask.test(p)) emit(Event::ENTITY_APPEARED, p, Type::TRAP);
+            break;
         default: assert(false);
         }
     }
 };
 
+//----------------------------------TurnInput----------------------------------------------------------
+// everything the referee send for one turn
+struct TurnInput {
+    struct EntityInput {
+        int id{0};
+        int type{0};  // 0 for your robot, 1 for other robot, 2 for radar, 3 for trap
+        int x{-1}, y{-1};
+        int item{-1};  // -1 for NONE, 2 for RADAR, 3 for TRAP, 4 for ORE
+    };
+
+    int myOre{0}, enemyOre{0};
+    array<array<int8_t, MAX_WIDTH>, MAX_HEIGHT> ore{};  // -1 for "?"
+    array<array<int8_t, MAX_WIDTH>, MAX_HEIGHT> hole{};
+    int radarCooldown{0}, trapCooldown{0};
+    vector<EntityInput> entities;
+
+    // same updates in the same order main() always did
+    void apply(Game& game) const {
+        game.updateOre(0, myOre);
+        game.updateOre(1, enemyOre);
+        for (int y = 0; y < MAX_HEIGHT; y++) {
+            for (int x = 0; x < MAX_WIDTH; x++) {
+                game.updateCell(x, y, ore[y][x], hole[y][x]);
+            }
+        }
+        game.updateCooldown(0, radarCooldown, trapCooldown);
+        for (const EntityInput& e : entities) game.updateEntity(e.id, e.type, e.x, e.y, e.item);
+    }
+};
+
+//----------------------------------TurnParser----------------------------------------------------------
+// reads the referee lines straight from a file descriptor: one read() per turn block,
+// no streams, no strings, "?" parses as -1
+struct TurnParser {
+    int fd{0};
+    array<char, 1 << 16> buffer;
+    int begin{0}, end{0};
+    bool eof{false};
+
+    int peek() {
+        if (begin == end) {
+            ssize_t n = eof ? 0 : read(fd, buffer.data(), buffer.size());
+            if (n <= 0) {
+                eof = true;
+                return -1;
+            }
+            begin = 0;
+            end = (int)n;
+        }
+        return buffer[begin];
+    }
+    int next() {
+        int c = peek();
+        while (c == ' ' || c == '\n' || c == '\r') {
+            begin++;
+            c = peek();
+        }
+        if (c == '?') {
+            begin++;
+            return -1;
+        }
+        bool negative = c == '-';
+        if (negative) {
+            begin++;
+            c = peek();
+        }
+        int value = 0;
+        while (c >= '0' && c <= '9') {
+            value = value * 10 + c - '0';
+            begin++;
+            c = peek();
+        }
+        return negative ? -value : value;
+    }
+
+    bool header(int& width, int& height) {
+        width = next();
+        height = next();
+        return !eof;
+    }
+    // entities keeps its capacity between turns, so a reused input never allocates
+    bool parse(TurnInput& input, int width, int height) {
+        input.myOre = next();
+        input.enemyOre = next();
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                input.ore[y][x] = (int8_t)next();
+                input.hole[y][x] = (int8_t)next();
+            }
+        }
+        int entityCount = next();
+        input.radarCooldown = next();
+        input.trapCooldown = next();
+        if (eof) return false;
+        input.entities.resize(entityCount);
+        for (TurnInput::EntityInput& e : input.entities) {
+            e.id = next();
+            e.type = next();
+            e.x = next();
+            e.y = next();
+            e.item = next();
+        }
+        return !eof;
+    }
+};
+
 //*********************************  GAME SIMULATION  **************************************************
 
 //----------------------------------Action----------------------------------------------------------
 struct Action {
     static const array<string, 4> LABELS_ACTIONS;
+    static const array<string, 21> LABELS_MESSAGES;
+    static constexpr int MAX_LENGTH = 48;  // "REQUEST RADAR GO HOME URGENT\n" with room to spare
 
     Point dest;
     ActionType type{ActionType::WAIT};
     Type item{Type::NONE};
-    string message;
+    Message message{Message::NONE};
 
-    void wait(string _message = "") {
+    void wait(Message _message = Message::NONE) {
         dest = Point{0, 0};
         type = ActionType::WAIT;
         item = Type::NONE;
         message = _message;
     }
-    void move(Point _dest, string _message = "") {
+    void move(Point _dest, Message _message = Message::NONE) {
         dest = _dest;
         type = ActionType::MOVE;
         item = Type::NONE;
         message = _message;
     }
-    void dig(Point _dest, string _message = "") {
+    void dig(Point _dest, Message _message = Message::NONE) {
         dest = _dest;
         type = ActionType::DIG;
         item = Type::NONE;
         message = _message;
     }
-    void request(Type _item, string _message = "") {
+    void request(Type _item, Message _message = Message::NONE) {
         dest = Point{0, 0};
         type = ActionType::REQUEST;
         item = _item;
         message = _message;
     }
+    // renders the command line without the newline, returns its length
+    int format(char* out) const {
+        char* p = out;
+        auto text = [&p](const char* s) {
+            while (*s) *p++ = *s++;
+        };
+        auto number = [&p](int v) {
+            if (v < 0) { *p++ = '-'; v = -v; }
+            if (v >= 10) *p++ = (char)('0' + v / 10);
+            *p++ = (char)('0' + v % 10);
+        };
+        text(LABELS_ACTIONS.at((int)(type)).c_str());
+        if (type == ActionType::MOVE || type == ActionType::DIG) {
+            *p++ = ' ';
+            number(dest.x);
+            *p++ = ' ';
+            number(dest.y);
+        }
+        if (type == ActionType::REQUEST && item == Type::RADAR) { text(" RADAR"); }
+        if (type == ActionType::REQUEST && item == Type::TRAP) { text(" TRAP"); }
+        if (message != Message::NONE) {
+            *p++ = ' ';
+            text(LABELS_MESSAGES.at((int)message).c_str());
+        }
+        return (int)(p - out);
+    }
     ostream& dump(ostream& ioOut) const {
-        ioOut << LABELS_ACTIONS.at((int)(type));
-        if (type == ActionType::MOVE || type == ActionType::DIG) { ioOut << " " << dest; }
-        if (type == ActionType::REQUEST && item == Type::RADAR) { ioOut << " RADAR"; }
-        if (type == ActionType::REQUEST && item == Type::TRAP) { ioOut << " TRAP"; }
-        if (message != "") { ioOut << " " << message; }
-        return ioOut;
+        char line[MAX_LENGTH];
+        return ioOut.write(line, format(line));
     }
 };
 const array<string, 4> Action::LABELS_ACTIONS{"WAIT", "MOVE", "DIG", "REQUEST"};
+const array<string, 21> Action::LABELS_MESSAGES{"", "READY", "OTW", "OTW W/Radar", "OTW TRAP", "OTW HOLE", "OTW KAMIKAZE",
+    "OTW Left4Dead", "DIG TRAP", "DESTROY", "KAMIKAZE", "sync attack !", "GO HOME", "GO HOME URGENT", "Wait HOME", "Evade!",
+    "GIMME RADAR!", "Gimme Trap", "Gimme HOLE", "Dreaming..", "Dead"};
+
+// all commands of the turn in one stack buffer, one write() to stdout
+void WriteActions(const array<Action, MAX_ROBOTS>& actions) {
+    char buffer[MAX_ROBOTS * Action::MAX_LENGTH];
+    int length = 0;
+    for (const Action& action : actions) {
+        length += action.format(buffer + length);
+        buffer[length++] = '\n';
+    }
+    for (int done = 0; done < length;) {
+        ssize_t n = write(1, buffer + done, length - done);
+        if (n <= 0) break;
+        done += (int)n;
+    }
+}
 
 ostream& operator<<(ostream& ioOut, const Action& obj) { return obj.dump(ioOut); }
 
-array<Point, MAX_ROBOTS> prevEnemyPos;
-array<Point, MAX_ROBOTS> prevOurPos;
-array<Action, MAX_ROBOTS> prevActions;
+//----------------------------------GameState----------------------------------------------------------
+// trivially copyable board for rollouts: cloning is one memcpy, apply() resolves a turn like the referee
+// ore -1 (unknown to us) digs as empty, enemy traps and radars are only there if the caller puts them
+struct GameState {
+    static constexpr int CELLS = MAX_WIDTH * MAX_HEIGHT;
+    struct Bot {
+        int8_t x{-1}, y{-1};
+        Type item{Type::NONE};
+        bool dead() const { return x == -1; }
+        Point pos() const { return Point{x, y}; }
+    };
+    using Orders = array<array<Action, MAX_ROBOTS>, MAX_PLAYERS>;
 
-int roll(int min, int max)
-{
-   // x is in [0,1[
-   double x = rand()/static_cast<double>(RAND_MAX+1); 
+    array<int8_t, CELLS> ore;
+    Bitboard holes;
+    Bitboard traps;  // owner does not matter, anyone digging one set it off
+    array<Bitboard, MAX_PLAYERS> radars;
+    array<array<Bot, MAX_ROBOTS>, MAX_PLAYERS> bots;
+    array<int16_t, MAX_PLAYERS> score{};
+    array<int8_t, MAX_PLAYERS> cooldownRadar{}, cooldownTrap{};
+    int16_t turn{0};
 
-   // [0,1[ * (max - min) + min is in [min,max[
-   int that = min + static_cast<int>( x * (max - min) );
+    static GameState from(Game& game) {
+        GameState s;
+        s.ore = game.grid.ore;
+        s.holes = game.holeMask;
+        s.traps = game.trapMask;
+        s.radars.at(0) = game.radarMask;
+        for (int owner = 0; owner < MAX_PLAYERS; owner++) {
+            Player& player = game.players.at(owner);
+            for (int i = 0; i < MAX_ROBOTS; i++) {
+                Robot& robot = player.robots.at(i);
+                s.bots.at(owner).at(i) = Bot{(int8_t)robot.x, (int8_t)robot.y, robot.item};
+            }
+            s.score.at(owner) = (int16_t)player.ore;
+            s.cooldownRadar.at(owner) = (int8_t)player.cooldownRadar;
+            s.cooldownTrap.at(owner) = (int8_t)player.cooldownTrap;
+        }
+        s.turn = (int16_t)game.turn;
+        return s;
+    }
 
-   return abs(that);
-}
+    // cell within range of from closest to dest, the straightest line on ties then lowest x, lowest y
+    static Point stepToward(Point from, Point dest, int range) {
+        int dx = dest.x - from.x, dy = dest.y - from.y;
+        int ax = abs(dx), ay = abs(dy);
+        int left = ax + ay - range;  // distance still to go after the step
+        if (left <= 0) return dest;
+        // split what is left as evenly as the box allows
+        int lo = max(0, left - ay), hi = min(ax, left);
+        int rx = min(max(left / 2, lo), hi);
+        if (left % 2 == 1 && left / 2 + 1 <= hi && left / 2 >= lo && rx == left / 2) {
+            // both halves as straight, take the lower x
+            if (dx > 0) rx = left / 2 + 1;
+        }
+        int ry = left - rx;
+        return Point{dest.x - (dx > 0 ? rx : -rx), dest.y - (dy > 0 ? ry : -ry)};
+    }
 
-bool CheckRadar(vector<Entity>& radars, Point _pt){
-    bool nearbyRadar = false;
-    for(int i = 0; i < radars.size(); i++){
-        if(_pt.distance(Point{radars.at(i).x, radars.at(i).y}) < 5){
-            nearbyRadar = true;
-            break;
+    void kill(Bot& bot) { bot = Bot{}; }
+
+    // requests, digs, trap explosions, moves then delivery, same order as the game
+    void apply(const Orders& orders) {
+        for (int owner = 0; owner < MAX_PLAYERS; owner++) {
+            for (int i = 0; i < MAX_ROBOTS; i++) {
+                Bot& bot = bots[owner][i];
+                const Action& action = orders[owner][i];
+                if (bot.dead() || action.type != ActionType::REQUEST || bot.x != 0) continue;
+                if (action.item == Type::RADAR && cooldownRadar[owner] == 0) {
+                    bot.item = Type::RADAR;
+                    cooldownRadar[owner] = ITEM_COOLDOWN;
+                }
+                if (action.item == Type::TRAP && cooldownTrap[owner] == 0) {
+                    bot.item = Type::TRAP;
+                    cooldownTrap[owner] = ITEM_COOLDOWN;
+                }
+            }
         }
-    }
-    return nearbyRadar;
-}
 
-int AdditionalRadarScore(Game& game, Point _pt){
-    int score = 0;
-    for(int _x = _pt.x-4; _x <= _pt.x+4; _x++){
-        for(int _y = _pt.y-4; _y <= _pt.y+4; _y++){
-            if(_x < 1 || _x >= MAX_WIDTH) continue;
-            if(_y < 0 || _y >= MAX_HEIGHT) continue;
-            // for distance smaller than 5 valid point
-            if(Point({_x,_y}).distance(_pt) < 5){
-                // undiscover score
-                if(game.get(_x,_y).ore == -1)
-                    score++;
-                // no visibility score
-                if(game.get(_x,_y).oreVisible == false)
-                    score++;
-            }
-        }
-    }
-    return score;
-}
+        Bitboard triggered;
+        for (int owner = 0; owner < MAX_PLAYERS; owner++) {
+            for (int i = 0; i < MAX_ROBOTS; i++) {
+                Bot& bot = bots[owner][i];
+                const Action& action = orders[owner][i];
+                Point dest = action.dest;
+                if (bot.dead() || action.type != ActionType::DIG) continue;
+                if (dest.x < 1 || !Bitboard::inside(dest.x, dest.y) || bot.pos().distance(dest) > 1) continue;
+                if (traps.test(dest)) {
+                    triggered.set(dest);
+                    continue;
+                }
+                holes.set(dest);
+                radars[1 - owner].reset(dest);
+                if (bot.item == Type::RADAR) radars[owner].set(dest);
+                if (bot.item == Type::TRAP) traps.set(dest);
+                if (bot.item == Type::RADAR || bot.item == Type::TRAP) bot.item = Type::NONE;
+                int8_t& cell = ore[Bitboard::index(dest.x, dest.y)];
+                if (bot.item == Type::NONE && cell > 0) {
+                    cell--;
+                    bot.item = Type::ORE;
+                }
+            }
+        }
+        if (triggered.any()) explode(triggered);
 
-bool CheckTrap(vector<Entity>& traps, Point _pt){
-    bool trapFound = false;
-    for(int j = 0; j < traps.size(); j++){
-        if(_pt.distance(Point{traps.at(j).x, traps.at(j).y}) <= 0){
-            trapFound = true;
-            break;
+        for (int owner = 0; owner < MAX_PLAYERS; owner++) {
+            for (int i = 0; i < MAX_ROBOTS; i++) {
+                Bot& bot = bots[owner][i];
+                const Action& action = orders[owner][i];
+                if (bot.dead() || !Bitboard::inside(action.dest.x, action.dest.y)) continue;
+                Point p = bot.pos();
+                int dist = p.distance(action.dest);
+                if (action.type == ActionType::MOVE) p = stepToward(p, action.dest, MOVE_RANGE);
+                if (action.type == ActionType::DIG && dist > 1) p = stepToward(p, action.dest, min(MOVE_RANGE, dist - 1));
+                bot.x = (int8_t)p.x;
+                bot.y = (int8_t)p.y;
+            }
         }
-    }
-    return trapFound;
-}
 
-void LinkedTraps(vector<Point>& v, vector<Entity>& traps, Point _pt){
-    for(int j = 0; j < traps.size(); j++){
-        if(traps.at(j).distance(Point{_pt.x, _pt.y}) == 1){
-            int index = -1;
-            for(int i = 0; i < v.size(); i++){
-                if(v.at(i).distance(traps.at(j))==0){
-                    index = i;
-                    break;
+        for (int owner = 0; owner < MAX_PLAYERS; owner++) {
+            for (Bot& bot : bots[owner]) {
+                if (bot.x == 0 && bot.item == Type::ORE) {
+                    score[owner]++;
+                    bot.item = Type::NONE;
                 }
             }
-            if(index == -1){
-                v.push_back(traps.at(j));
-                LinkedTraps(v, traps, traps.at(j));
+            if (cooldownRadar[owner] > 0) cooldownRadar[owner]--;
+            if (cooldownTrap[owner] > 0) cooldownTrap[owner]--;
+        }
+        turn++;
+    }
+
+    // every trap chained to a triggered one goes off, robots beside any of them die
+    void explode(Bitboard blown) {
+        blown = blown & traps;
+        for (Bitboard grown = blown.dilate(1) & traps; grown.andNot(blown).any(); grown = blown.dilate(1) & traps) blown = grown;
+        traps = traps.andNot(blown);
+        Bitboard blast = blown.dilate(TRAP_RANGE);
+        for (auto& team : bots) {
+            for (Bot& bot : team) {
+                if (!bot.dead() && blast.test(bot.pos())) kill(bot);
             }
         }
     }
-}
+};
+static_assert(is_trivially_copyable<GameState>::value, "rollouts copy GameState with memcpy");
 
-void LinkedDangerTraps(vector<Point>& v, Point _pt){
-    for(int j = 0; j < dangerPointList.size(); j++){
-        if(dangerPointList.at(j).distance(Point{_pt.x, _pt.y}) == 1){
-            int index = -1;
-            for(int i = 0; i < v.size(); i++){
-                if(v.at(i).distance(dangerPointList.at(j))==0){
-                    index = i;
-                    break;
+//----------------------------------TurnMemory----------------------------------------------------------
+// what a bot carries from its last turn, the danger list and its own random state
+struct TurnMemory {
+    CellRegistry dangerPointList; // danger list dont ever go there
+    CellRegistry holePointList; // danger list dont ever go there
+    ChainIndex dangerChains; // danger point linked together
+    array<Point, MAX_ROBOTS> prevEnemyPos;
+    array<Point, MAX_ROBOTS> prevOurPos;
+    array<Action, MAX_ROBOTS> prevActions;
+    uint32_t rngState = 2463534242u;  // xorshift so the state can be recorded and replayed
+
+    uint32_t nextRandom(){
+        rngState ^= rngState << 13;
+        rngState ^= rngState >> 17;
+        rngState ^= rngState << 5;
+        return rngState;
+    }
+    // in [min,max[
+    int roll(int min, int max){
+        double x = nextRandom() / 4294967296.0;
+        return abs(min + static_cast<int>(x * (max - min)));
+    }
+
+    // robot k stayed beside its dig target of last turn, so the dig went through
+    bool dugLastTurn(Player& me, int k) const {
+        Point p = prevActions.at(k).dest;
+        return !me.robots.at(k).isDead() && prevActions.at(k).type == ActionType::DIG &&
+            me.robots.at(k).distance(p) <= DIG_RANGE && me.robots.at(k).distance(prevOurPos.at(k)) == 0;
+    }
+    // one of ours dug _pt last turn
+    bool ourDig(Player& me, Point _pt) const {
+        for(int k = 0; k < MAX_ROBOTS; k++){
+            if(dugLastTurn(me, k) && prevActions.at(k).dest.distance(_pt) == 0)
+                return true;
+        }
+        return false;
+    }
+
+    bool isDanger(Point _pt) const {
+        return dangerPointList.contains(_pt);
+    }
+    void insertDangerPt(Point _pt, int turn, Reason reason){
+        // this tile is cause by enemy 100%
+        dangerPointList.insert(_pt, turn, reason); // mean something is here
+        dangerChains.add(_pt);
+    }
+    void removeDangerPt(Point _pt){
+        dangerPointList.remove(_pt); // release point
+        dangerChains.remove(_pt);
+    }
+    void insertHolePt(Point _pt, int turn, Reason reason){
+        // this tile is cause by enemy 100%
+        holePointList.insert(_pt, turn, reason); // mean something is here
+    }
+    void removeHolePt(Point _pt){
+        holePointList.remove(_pt); // release point
+    }
+};
+
+// one pass over the turn's events: holes and ore changes are ours where our dig went through, the enemy's
+// otherwise, then what every robot did since last turn and the entities gone from the input
+void ClassifyEvents(const TurnMemory& memory, Game& game){
+    if(game.classified) return;
+    game.classified = true;
+    Player& me = game.players.at(0);
+    Bitboard ourDigs;
+    for(int k = 0; k < MAX_ROBOTS; k++){
+        Point p = memory.prevActions.at(k).dest;
+        if(memory.dugLastTurn(me, k) && Bitboard::inside(p.x, p.y)) ourDigs.set(p);
+    }
+    for(TurnEvent& e : game.events){
+        if(e.type == Event::NEW_HOLE || e.type == Event::ORE_REDUCED) e.owner = ourDigs.test(e.p) ? 0 : 1;
+        else if(e.type == Event::CELL_CHANGED && ourDigs.test(e.p)) e.owner = 0;
+        else if(e.type == Event::ENTITY_APPEARED) e.owner = 0;
+    }
+
+    for(int owner = 0; owner < MAX_PLAYERS; owner++){
+        const array<Point, MAX_ROBOTS>& prev = owner == 0 ? memory.prevOurPos : memory.prevEnemyPos;
+        for(int i = 0; i < MAX_ROBOTS; i++){
+            Robot& robot = game.players.at(owner).robots.at(i);
+            TurnEvent e;
+            e.type = Event::ROBOT_PAUSED;
+            e.owner = owner;
+            e.robot = i;
+            e.p = robot;
+            e.from = prev.at(i);
+            if(robot.isDead()){
+                // once, on the turn it went
+                if(e.from.x != -1 || e.from.y != -1){
+                    e.type = Event::ROBOT_LOST;
+                    game.events.push_back(e);
                 }
+                continue;
+            }
+            if(robot.distance(e.from) == 0){
+                game.events.push_back(e);
+                Point dest = memory.prevActions.at(i).dest;
+                if(owner == 0 && memory.dugLastTurn(me, i) && Bitboard::inside(dest.x, dest.y)){
+                    e.type = Event::ROBOT_DUG;
+                    e.p = dest;
+                    game.events.push_back(e);
+                }
+                continue;
             }
-            if(index == -1){
-                v.push_back(dangerPointList.at(j));
-                LinkedDangerTraps(v, dangerPointList.at(j));
+            e.type = Event::ROBOT_MOVED;
+            game.events.push_back(e);
+            if(e.from.x > 0 && robot.x == 0){
+                e.type = Event::ROBOT_HOME;
+                game.events.push_back(e);
             }
         }
     }
+
+    auto gone = [&](Bitboard cells, Type item){
+        cells.forEach([&](Point p){
+            game.emit(Event::ENTITY_GONE, p, item);
+            game.events.back().owner = 0;
+        });
+    };
+    gone(game.lastRadarMask.andNot(game.radarMask), Type::RADAR);
+    gone(game.lastTrapMask.andNot(game.trapMask), Type::TRAP);
 }
 
-bool IsSafety(vector<Entity>& traps, Player& me, Player& enemy, array<Action, MAX_ROBOTS>& actions, Point _pt){
-    // if one of enemy robot in explosion range, only one robot can go in that range
-    bool isSafe = true;
-    bool alreadyOne = false;
-    bool enemyNear = false;
-    vector<Point> linkTraps;
-    vector<Point> linkDangerTraps;
-    
-    for(int j = 0; j < traps.size(); j++){
-        if(traps.at(j).distance(Point{_pt.x, _pt.y}) <= 1){
-            // find all trap linked to this trap
-            linkTraps.push_back(traps.at(j));
-            LinkedTraps(linkTraps, traps, traps.at(j));
-            
-            for(int i = 0; i < MAX_ROBOTS; i++){
-                for(int j = 0; j < linkTraps.size(); j++){
-                    if(me.robots.at(i).distance(linkTraps.at(j)) <= 1 || actions.at(i).dest.distance(linkTraps.at(j)) <= 1){
-                        alreadyOne = true;
-                        break;
+//----------------------------------OreBelief----------------------------------------------------------
+// ore amount distribution of every cell from the map generator, latent veins per possible center:
+// a cell has ore when a vein in range reached it, each vein reaches a cell in range with chance 1/2.
+// Radar reveals, our digs and where an enemy walks after a fresh hole are evidence about which cells
+// were reached, the vein centers weigh that evidence and every cell around reads them back.
+struct OreBelief {
+    static constexpr int CELLS = MAX_WIDTH * MAX_HEIGHT;
+    static constexpr int AMOUNTS = MAX_ORE + 1;
+    static constexpr int VEINS = 4;               // 0 to 3 veins on the same center
+    static constexpr int SWEEPS = 3;              // mean field passes over the centers
+    static constexpr float HOME_IF_ORE = 0.9f;    // enemy heads home after a dig that gave ore
+    static constexpr float HOME_IF_EMPTY = 0.2f;  // or goes home anyway to fetch an item
+    using Dist = array<float, AMOUNTS>;
+
+    bool ready{false};
+    array<float, CELLS> hitLik, missLik;  // evidence on the cell being reached by a vein, 1 1 for none
+    array<float, CELLS> centerMiss;       // E[0.5^veins] of a center, the chance its veins all skip a cell in range
+    array<float, CELLS> cellMiss;         // product of centerMiss over the centers in range of the cell
+    array<float, CELLS> removed;          // ore dug out since the amount was last seen
+    array<float, CELLS> mean;
+    array<float, CELLS> variance;
+    Bitboard prevVisible;
+    Bitboard prevHoles;
+    array<Type, MAX_ROBOTS> ourItems;
+    array<Bitboard, MAX_ROBOTS> enemyDigs;  // fresh holes an enemy stood beside, until it walks away
+
+    // amounts a vein adds to a cell it can reach: 1 to MAX_ORE with chance 1/2
+    static Dist VeinDraw(float chance){
+        Dist d{};
+        d.at(0) = 1 - chance / 2;
+        for(int a = 1; a < AMOUNTS; a++) d.at(a) = chance / 2 / MAX_ORE;
+        return d;
+    }
+    // d then one more vein, capped at MAX_ORE
+    static Dist AddVein(const Dist& d, const Dist& draw){
+        Dist r{};
+        for(int a = 0; a < AMOUNTS; a++){
+            for(int b = 0; b < AMOUNTS; b++) r.at(min(a + b, MAX_ORE)) += d.at(a) * draw.at(b);
+        }
+        return r;
+    }
+    static bool IsCenter(int x, int y){ return x >= ORE_VEIN_MIN_X && Bitboard::inside(x, y); }
+    template <class F>
+    static void ForEachInRange(Point p, F f){
+        for(int x = p.x - ORE_VEIN_RANGE; x <= p.x + ORE_VEIN_RANGE; x++){
+            int dy = ORE_VEIN_RANGE - abs(x - p.x);
+            for(int y = p.y - dy; y <= p.y + dy; y++){
+                if(Bitboard::inside(x, y)) f(x, y);
+            }
+        }
+    }
+    static int VeinCenters(Point p){
+        int n = 0;
+        ForEachInRange(p, [&](int x, int y){ n += IsCenter(x, y); });
+        return n;
+    }
+    // veins on the map: area * density, density uniform, rounded down
+    static double VeinWeight(int veins){
+        const double lo = CELLS * ORE_VEIN_DENSITY_MIN, hi = CELLS * ORE_VEIN_DENSITY_MAX;
+        return max(0.0, min(hi, veins + 1.0) - max(lo, (double)veins)) / (hi - lo);
+    }
+    static constexpr int MAX_VEINS = (int)(CELLS * ORE_VEIN_DENSITY_MAX) + 1;
+    static const array<Dist, CELLS>& Prior(){
+        static const array<Dist, CELLS> table = []{
+            array<Dist, CELLS> r{};
+            const float centers = (MAX_WIDTH - ORE_VEIN_MIN_X) * MAX_HEIGHT;
+            for(int x = 0; x < MAX_WIDTH; x++){
+                for(int y = 0; y < MAX_HEIGHT; y++){
+                    Dist& d = r.at(Bitboard::index(x, y));
+                    if(x < 1){
+                        d.at(0) = 1;
+                        continue;
+                    }
+                    Dist draw = VeinDraw(VeinCenters(Point{x, y}) / centers);
+                    Dist after{1};
+                    for(int veins = 1; veins < MAX_VEINS; veins++){
+                        after = AddVein(after, draw);
+                        for(int a = 0; a < AMOUNTS; a++) d.at(a) += VeinWeight(veins) * after.at(a);
                     }
                 }
             }
-            
-            for(int i = 0; i < MAX_ROBOTS; i++){
-                for(int j = 0; j < linkTraps.size(); j++){
-                    if(enemy.robots.at(i).distance(linkTraps.at(j)) <= 5 && enemy.robots.at(i).distance(linkTraps.at(j)) < prevEnemyPos.at(i).distance(linkTraps.at(j))){
-                        enemyNear = true;
-                        break;
-                    }
-                    if(enemy.robots.at(i).distance(linkTraps.at(j)) <= 1){
-                        enemyNear = true;
-                        break;
-                    }
+            return r;
+        }();
+        return table;
+    }
+    // veins on one center, Poisson at the mean vein count over the centers
+    static const array<float, VEINS>& CenterPrior(){
+        static const array<float, VEINS> table = []{
+            double expected = 0;
+            for(int veins = 1; veins < MAX_VEINS; veins++) expected += veins * VeinWeight(veins);
+            double rate = expected / ((MAX_WIDTH - ORE_VEIN_MIN_X) * MAX_HEIGHT), total = 0;
+            array<float, VEINS> r{};
+            for(int v = 0; v < VEINS; v++){
+                r.at(v) = exp(-rate) * pow(rate, v) / tgamma(v + 1);
+                total += r.at(v);
+            }
+            for(float& p : r) p /= total;
+            return r;
+        }();
+        return table;
+    }
+    static constexpr array<float, VEINS> SKIP{1, 0.5f, 0.25f, 0.125f};  // all veins skip a cell in range
+    static float PriorCenterMiss(){
+        static const float miss = []{
+            float m = 0;
+            for(int v = 0; v < VEINS; v++) m += CenterPrior().at(v) * SKIP.at(v);
+            return m;
+        }();
+        return miss;
+    }
+
+    // no evidence yet, the same every game so built once and copied
+    void reset(){
+        static const OreBelief fresh = []{
+            OreBelief b;
+            b.hitLik.fill(1);
+            b.missLik.fill(1);
+            b.removed.fill(0);
+            for(int x = 0; x < MAX_WIDTH; x++){
+                for(int y = 0; y < MAX_HEIGHT; y++){
+                    b.centerMiss.at(Bitboard::index(x, y)) = IsCenter(x, y) ? PriorCenterMiss() : 1;
+                    b.cellMiss.at(Bitboard::index(x, y)) = pow(PriorCenterMiss(), VeinCenters(Point{x, y}));
                 }
             }
-            if(alreadyOne && enemyNear){
-                isSafe = false;
-                return isSafe;
+            b.ourItems.fill(Type::NONE);
+            b.ready = true;
+            b.refresh(Bitboard{}, Bitboard{}, Bitboard::full());
+            return b;
+        }();
+        *this = fresh;
+    }
+
+    // posterior of the veins on center c against the evidence of the cells in its range,
+    // the other centers of each cell as currently weighed so a vein already found explains its cells
+    void weighCenter(Point c){
+        array<float, VEINS> post = CenterPrior();
+        int c0 = Bitboard::index(c.x, c.y);
+        float self = centerMiss.at(c0);
+        ForEachInRange(c, [&](int x, int y){
+            int i = Bitboard::index(x, y);
+            if(hitLik.at(i) == missLik.at(i)) return;
+            float others = cellMiss.at(i) / self;
+            for(int v = 0; v < VEINS; v++){
+                float miss = SKIP.at(v) * others;
+                post.at(v) *= hitLik.at(i) * (1 - miss) + missLik.at(i) * miss;
+            }
+        });
+        float total = 0, miss = 0;
+        for(int v = 0; v < VEINS; v++){
+            total += post.at(v);
+            miss += post.at(v) * SKIP.at(v);
+        }
+        float weighed = total > 0 ? miss / total : PriorCenterMiss();
+        // never below SKIP.back(), the ratio is safe
+        ForEachInRange(c, [&](int x, int y){ cellMiss.at(Bitboard::index(x, y)) *= weighed / self; });
+        centerMiss.at(c0) = weighed;
+    }
+    // chance a vein reached cell p, from its centers and its own evidence
+    float hitChance(Point p) const {
+        int i = Bitboard::index(p.x, p.y);
+        float miss = cellMiss.at(i);
+        float hit = (1 - miss) * hitLik.at(i), total = hit + miss * missLik.at(i);
+        return total > 0 ? hit / total : 0;
+    }
+    Dist amounts(Point p) const {
+        int i = Bitboard::index(p.x, p.y);
+        const Dist& prior = Prior().at(i);
+        float hit = p.x < 1 || prior.at(0) >= 1 ? 0 : hitChance(p);
+        Dist d{};
+        d.at(0) = 1 - hit;
+        for(int a = 1; a < AMOUNTS; a++) d.at(a) = hit * prior.at(a) / (1 - prior.at(0));
+        // one shift per whole ore dug out, the fraction mixes one more
+        auto shift = [](const Dist& from){
+            Dist r{};
+            for(int a = 0; a < AMOUNTS; a++) r.at(max(a - 1, 0)) += from.at(a);
+            return r;
+        };
+        float taken = removed.at(i);
+        for(; taken >= 1; taken--) d = shift(d);
+        Dist shifted = shift(d);
+        for(int a = 0; a < AMOUNTS; a++) d.at(a) = (1 - taken) * d.at(a) + taken * shifted.at(a);
+        return d;
+    }
+    // centers around changed evidence, then every cell reading them, visible cells are the radar amount
+    void refresh(const Bitboard& changed, const Bitboard& visible, const Bitboard& moved){
+        Bitboard centers = changed.dilate(ORE_VEIN_RANGE);
+        for(int sweep = 0; sweep < SWEEPS; sweep++){
+            centers.forEach([&](Point c){
+                if(IsCenter(c.x, c.y)) weighCenter(c);
+            });
+        }
+        Bitboard cells = (centers.dilate(ORE_VEIN_RANGE) | moved).andNot(visible);
+        cells.forEach([&](Point p){
+            Dist d = amounts(p);
+            int i = Bitboard::index(p.x, p.y);
+            float m = 0, m2 = 0;
+            for(int a = 1; a < AMOUNTS; a++){
+                m += a * d.at(a);
+                m2 += a * a * d.at(a);
+            }
+            mean.at(i) = m;
+            variance.at(i) = m2 - m * m;
+        });
+    }
+    void observe(Point p, bool hit, Bitboard& changed){
+        int i = Bitboard::index(p.x, p.y);
+        if(hitLik.at(i) == (hit ? 1 : 0) && missLik.at(i) == (hit ? 0 : 1)) return;
+        hitLik.at(i) = hit;
+        missLik.at(i) = !hit;
+        changed.set(p);
+    }
+
+    // reads the turn's events, ClassifyEvents has run
+    void update(Game& game, Player& me){
+        bool fresh = !ready;
+        if(!ready) reset();
+        Bitboard changed, moved;
+
+        // radar tells the amount, and whether a vein reached the cell unless the cell was dug;
+        // a visible cell keeps its reading until it changes
+        auto see = [&](Point p){
+            int i = Bitboard::index(p.x, p.y);
+            int ore = game.get(p).ore;
+            if(ore > 0) observe(p, true, changed);
+            else if(!game.holeMask.test(p)) observe(p, false, changed);
+            removed.at(i) = 0;
+            mean.at(i) = ore;
+            variance.at(i) = 0;
+        };
+        if(fresh) game.visibleMask.forEach(see);
+        else{
+            for(const TurnEvent& e : game.events){
+                if(e.type == Event::CELL_CHANGED && game.visibleMask.test(e.p)) see(e.p);
             }
-                
         }
-    }
-    
-    isSafe = true;
-    alreadyOne = false;
-    enemyNear = false;
-    
-    for(int j = 0; j < dangerPointList.size(); j++){
-        if(dangerPointList.at(j).distance(Point{_pt.x, _pt.y}) <= 1){
-            // find all trap linked to this trap
-            linkDangerTraps.push_back(dangerPointList.at(j));
-            LinkedDangerTraps(linkDangerTraps, dangerPointList.at(j));
-            
-            for(int i = 0; i < MAX_ROBOTS; i++){
-                for(int j = 0; j < linkDangerTraps.size(); j++){
-                    if(me.robots.at(i).distance(linkDangerTraps.at(j)) <= 1 || actions.at(i).dest.distance(linkDangerTraps.at(j)) <= 1){
-                        alreadyOne = true;
-                        break;
-                    }
-                }
+        moved = prevVisible.andNot(game.visibleMask);
+
+        // our digs, the robot stopped beside the cell and came back with ore or not
+        for(const TurnEvent& e : game.events){
+            if(e.type != Event::ROBOT_DUG || e.p.x < 1 || game.visibleMask.test(e.p)) continue;
+            bool found = me.robots.at(e.robot).item == Type::ORE && ourItems.at(e.robot) != Type::ORE;
+            if(found){
+                observe(e.p, true, changed);
+                removed.at(Bitboard::index(e.p.x, e.p.y)) += 1;
+                moved.set(e.p);
             }
-            
-            for(int i = 0; i < MAX_ROBOTS; i++){
-                for(int j = 0; j < linkDangerTraps.size(); j++){
-                    if(enemy.robots.at(i).distance(linkDangerTraps.at(j)) <= 5 && enemy.robots.at(i).distance(linkDangerTraps.at(j)) < prevEnemyPos.at(i).distance(linkDangerTraps.at(j))){
-                        enemyNear = true;
-                        break;
-                    }
-                    if(enemy.robots.at(i).distance(linkDangerTraps.at(j)) <= 1){
-                        enemyNear = true;
-                        break;
+            else if(!prevHoles.test(e.p)){
+                observe(e.p, false, changed);
+            }
+        }
+        for(int k = 0; k < MAX_ROBOTS; k++) ourItems.at(k) = me.robots.at(k).item;
+
+        // enemy digs, walking toward base next is the ore going home
+        Bitboard enemyHoles = game.eventCells(Event::NEW_HOLE, 1);
+        for(const TurnEvent& e : game.events){
+            if(e.owner != 1 || e.robot < 0) continue;
+            Bitboard& digs = enemyDigs.at(e.robot);
+            if(e.type == Event::ROBOT_LOST){
+                digs.clear();
+            }
+            else if(e.type == Event::ROBOT_MOVED && digs.any()){
+                bool home = e.p.x < e.from.x;
+                float weight = 1.0f / digs.count();
+                digs.andNot(game.visibleMask).forEach([&](Point p){
+                    int c = Bitboard::index(p.x, p.y);
+                    float ifOre = home ? HOME_IF_ORE : 1 - HOME_IF_ORE;
+                    float ifEmpty = home ? HOME_IF_EMPTY : 1 - HOME_IF_EMPTY;
+                    hitLik.at(c) *= weight * ifOre + 1 - weight;
+                    missLik.at(c) *= weight * ifEmpty + 1 - weight;
+                    changed.set(p);
+                    if(home){
+                        refresh(changed, game.visibleMask, moved);
+                        removed.at(c) += weight * hitChance(p);
+                        moved.set(p);
                     }
-                }
+                });
+                digs.clear();
             }
-            if(alreadyOne && enemyNear){
-                isSafe = false;
-                return isSafe;
+            else if(e.type == Event::ROBOT_PAUSED && e.p.x > 0){
+                Bitboard around;
+                around.set(e.p);
+                digs = digs | (around.dilate(DIG_RANGE) & enemyHoles);
             }
-                
         }
+
+        refresh(changed, game.visibleMask, moved);
+        prevVisible = game.visibleMask;
+        prevHoles = game.holeMask;
     }
-    
-    for(int j = 0; j < MAX_ROBOTS; j++){
-        if(suspectID.at(j) && _pt.distance(enemy.robots.at(suspectID.at(j))) <= 1){
-            isSafe = false;
-            return isSafe;
+    float expected(Point p) const { return mean.at(Bitboard::index(p.x, p.y)); }
+    float uncertainty(Point p) const { return variance.at(Bitboard::index(p.x, p.y)); }
+};
+
+//----------------------------------TrapBelief----------------------------------------------------------
+// chance an enemy trap is buried in each cell. An enemy robot pausing at base picks an item up, its next
+// pause beside a fresh hole or an ore it did not take puts the item there, a pause beside old holes only
+// likely into one of them. A dig of ours that went through clears the cell. Cells reaching DANGER_RISK
+// make the danger list the rest of the bot reads.
+struct TrapBelief {
+    static constexpr int CELLS = MAX_WIDTH * MAX_HEIGHT;
+    static constexpr float TRAP_SHARE = 0.5f;     // item picked at base is a trap rather than a radar
+    static constexpr float PLANT_IN_OLD = 0.8f;   // pause beside old holes only, the item went into one
+    static constexpr float DANGER_RISK = 0.05f;
+
+    array<float, CELLS> risk{};
+    array<float, MAX_ROBOTS> carry{};  // chance each enemy robot holds an item
+    Bitboard risky;                    // risk above 0
+
+    float at(Point p) const { return Bitboard::inside(p.x, p.y) ? risk.at(Bitboard::index(p.x, p.y)) : 0; }
+    // a trap went into p with chance, on top of what may be there already
+    void raise(TurnMemory& memory, Point p, float chance, int turn, Reason reason){
+        if(chance <= 0 || !Bitboard::inside(p.x, p.y)) return;
+        float& r = risk.at(Bitboard::index(p.x, p.y));
+        r = 1 - (1 - r) * (1 - chance);
+        risky.set(p);
+        if(r >= DANGER_RISK) memory.insertDangerPt(p, turn, reason);
+    }
+    void clear(TurnMemory& memory, Point p){
+        if(!risky.test(p)) return;
+        risk.at(Bitboard::index(p.x, p.y)) = 0;
+        risky.reset(p);
+        if(memory.isDanger(p)) memory.removeDangerPt(p);
+    }
+
+    // reads the turn's events, ClassifyEvents has run
+    void update(TurnMemory& memory, Game& game){
+        // our digs went through, nothing is buried there
+        for(const TurnEvent& e : game.events){
+            if(e.type == Event::ROBOT_DUG) clear(memory, e.p);
+        }
+
+        // holes and ore changes of the enemy
+        Bitboard newHoles = game.eventCells(Event::NEW_HOLE, 1);
+        Bitboard reduced = game.eventCells(Event::ORE_REDUCED, 1);
+        // item of enemy i into one of cells, still held with chance 1 - planted
+        auto plant = [&](int i, const Bitboard& cells, float planted){
+            int k = cells.count();
+            if(k == 0) return;
+            float chance = carry.at(i) * planted * TRAP_SHARE / k;
+            cells.forEach([&](Point p){
+                raise(memory, p, chance, game.turn, newHoles.test(p) ? Reason::NEW_HOLE : reduced.test(p) ? Reason::ORE_REDUCE : Reason::ENEMY_STOP);
+            });
+            carry.at(i) *= 1 - planted;
+        };
+        for(const TurnEvent& e : game.events){
+            if(e.owner != 1 || e.robot < 0) continue;
+            int i = e.robot;
+            // destroyed, or back at base and whatever it held is buried
+            if(e.type == Event::ROBOT_LOST || e.type == Event::ROBOT_HOME){
+                carry.at(i) = 0;
+                continue;
+            }
+            if(e.type != Event::ROBOT_PAUSED) continue;
+            Bitboard around;
+            around.set(e.p);
+            around = around.dilate(DIG_RANGE).andNot(Bitboard::column(0));
+            Bitboard dug = around & (newHoles | reduced);
+            if(dug.any() && carry.at(i) > 0)
+                plant(i, dug, 1);
+            else if(e.p.x == 0)
+                carry.at(i) = 1;  // a pause at base is an item request
+            else if(carry.at(i) > 0)
+                plant(i, around & game.holeMask, PLANT_IN_OLD);
         }
     }
-    
-    return isSafe;
-}
+};
 
-bool IsNewHole(Game& game, Point _pt){
-    bool isNew = false;
-    for(int j = 0; j < game.newHoleList.size(); j++){
-        if(game.newHoleList.at(j).distance(Point{_pt.x, _pt.y}) <= 0){
-            isNew = true;
+bool CheckRadar(vector<Entity>& radars, Point _pt){
+    bool nearbyRadar = false;
+    for(int i = 0; i < radars.size(); i++){
+        if(_pt.distance(Point{radars.at(i).x, radars.at(i).y}) < 5){
+            nearbyRadar = true;
             break;
         }
     }
-    return isNew;
+    return nearbyRadar;
+}
+
+int AdditionalRadarScore(Game& game, Point _pt){
+    PROFILE_COUNT(Counter::ADDITIONAL_RADAR_SCORE);
+    // undiscover and no visibility score, maintained incrementally by updateCell
+    return game.get(_pt).unknown;
 }
 
-bool IsReduce(Game& game, Point _pt){
-    bool isReduce = false;
-    for(int j = 0; j < game.oreReduceList.size(); j++){
-        if(game.oreReduceList.at(j).distance(Point{_pt.x, _pt.y}) <= 0){
-            isReduce = true;
+bool CheckTrap(vector<Entity>& traps, Point _pt){
+    bool trapFound = false;
+    for(int j = 0; j < traps.size(); j++){
+        if(_pt.distance(Point{traps.at(j).x, traps.at(j).y}) <= 0){
+            trapFound = true;
             break;
         }
     }
-    return isReduce;
+    return trapFound;
 }
 
-bool IsDanger(Point _pt){
-    bool danger = false;
-    for(int j = 0; j < dangerPointList.size(); j++){
-        if(_pt.distance(Point{dangerPointList.at(j).x, dangerPointList.at(j).y}) <= 0){
-            danger = true;
-            break;
-        }
+// chains touching _pt, unsafe if one of ours already beside and enemy beside or coming
+bool ChainUnsafe(const TurnMemory& memory, ChainIndex& chains, Player& me, Player& enemy, array<Action, MAX_ROBOTS>& actions, Point _pt){
+    array<int, ChainIndex::NEIGHBOURS> roots;
+    int count = chains.touching(_pt, roots);
+    bool alreadyOne = false;
+    bool enemyNear = false;
+    for(int r = 0; r < count; r++){
+        Bitboard blast = chains.blast(roots.at(r));
+        for(int i = 0; i < MAX_ROBOTS; i++){
+            if(blast.test(me.robots.at(i)) || blast.test(actions.at(i).dest))
+                alreadyOne = true;
+            if(blast.test(enemy.robots.at(i)))
+                enemyNear = true;
+        }
+        if(enemyNear) continue;
+        chains.forEachMember(roots.at(r), [&](Point link){
+            PROFILE_COUNT(Counter::CHAIN_MEMBERS);
+            for(int i = 0; i < MAX_ROBOTS; i++){
+                if(enemy.robots.at(i).distance(link) <= 5 && enemy.robots.at(i).distance(link) < memory.prevEnemyPos.at(i).distance(link)){
+                    enemyNear = true;
+                }
+            }
+        });
     }
+    return alreadyOne && enemyNear;
+}
 
-    return danger;
+// IsSafety from scratch, for cells out of the board
+bool ScanSafety(const TurnMemory& memory, Game& game, Player& me, Player& enemy, array<Action, MAX_ROBOTS>& actions, Point _pt, ChainIndex& dangers){
+    // if one of enemy robot in explosion range, only one robot can go in that range
+    if(ChainUnsafe(memory, game.trapChains, me, enemy, actions, _pt))
+        return false;
+    if(ChainUnsafe(memory, dangers, me, enemy, actions, _pt))
+        return false;
+    
+    return true;
 }
 
-void InsertDangerPt(Point _pt){
-    // this tile is cause by enemy 100%
-    bool exist = false;
-    for(int k = 0; k < dangerPointList.size(); k++){
-        if(dangerPointList.at(k).distance(_pt) == 0)
-        {
-            exist = true;
-            break;
+//----------------------------------SafetyMap----------------------------------------------------------
+// IsSafety of every cell, built once a turn then patched when a robot destination change
+struct SafetyMap {
+    static constexpr int INDEXES = 2;  // trap chains, danger chains
+    struct Chain {
+        Bitboard blast;
+        bool ourNear{false};
+    };
+
+    int turn{-1};
+    array<vector<Chain>, INDEXES> chains;
+    array<Bitboard, INDEXES> enemyZone;  // blast of chains with enemy beside or coming
+    Bitboard unsafe;
+    array<Point, MAX_ROBOTS> dests;
+
+    // chains only add up over a game, room for a crowded board up front keeps the turns allocation free
+    SafetyMap(){ for(vector<Chain>& list : chains) list.reserve(64); }
+
+    void build(TurnMemory& memory, Game& game, Player& me, Player& enemy, array<Action, MAX_ROBOTS>& actions){
+        PROFILE_COUNT(Counter::SAFETY_BUILD);
+        turn = game.turn;
+        array<ChainIndex*, INDEXES> indexes{&game.trapChains, &memory.dangerChains};
+        for(int k = 0; k < INDEXES; k++){
+            ChainIndex& index = *indexes.at(k);
+            chains.at(k).clear();
+            enemyZone.at(k).clear();
+            index.members.forEach([&](Point p){
+                int r = Bitboard::index(p.x, p.y);
+                if(index.find(r) != r) return;
+                Chain chain;
+                chain.blast = index.blast(r);
+                bool enemyNear = false;
+                for(int i = 0; i < MAX_ROBOTS; i++){
+                    if(chain.blast.test(me.robots.at(i)))
+                        chain.ourNear = true;
+                    if(chain.blast.test(enemy.robots.at(i)))
+                        enemyNear = true;
+                }
+                index.forEachMember(r, [&](Point link){
+                    for(int i = 0; i < MAX_ROBOTS; i++){
+                        if(enemy.robots.at(i).distance(link) <= 5 && enemy.robots.at(i).distance(link) < memory.prevEnemyPos.at(i).distance(link)){
+                            enemyNear = true;
+                        }
+                    }
+                });
+                if(enemyNear)
+                    enemyZone.at(k) = enemyZone.at(k) | chain.blast;
+                chains.at(k).push_back(chain);
+            });
+        }
+        patch(actions);
+    }
+    // only one of ours in a chain blast when enemy around
+    void patch(array<Action, MAX_ROBOTS>& actions){
+        PROFILE_COUNT(Counter::SAFETY_PATCH);
+        for(int i = 0; i < MAX_ROBOTS; i++)
+            dests.at(i) = actions.at(i).dest;
+        unsafe.clear();
+        for(int k = 0; k < INDEXES; k++){
+            Bitboard alreadyOne;
+            for(Chain& chain : chains.at(k)){
+                bool ourNear = chain.ourNear;
+                for(int i = 0; i < MAX_ROBOTS; i++)
+                    ourNear = ourNear || chain.blast.test(dests.at(i));
+                if(ourNear)
+                    alreadyOne = alreadyOne | chain.blast;
+            }
+            unsafe = unsafe | (alreadyOne & enemyZone.at(k));
+        }
+    }
+    // cells not safe for this turn and current actions
+    const Bitboard& follow(TurnMemory& memory, Game& game, Player& me, Player& enemy, array<Action, MAX_ROBOTS>& actions){
+        if(turn != game.turn){
+            build(memory, game, me, enemy, actions);
+            return unsafe;
         }
+        for(int i = 0; i < MAX_ROBOTS; i++){
+            if(dests.at(i).x != actions.at(i).dest.x || dests.at(i).y != actions.at(i).dest.y){
+                patch(actions);
+                break;
+            }
+        }
+        return unsafe;
     }
-    if(!exist) 
-        dangerPointList.push_back(_pt); // mean something is here
-}
+};
 
-void RemoveDangerPt(Point _pt){
-    // this tile is cause by enemy 100%
-    int index = -1;
-    for(int k = 0; k < dangerPointList.size(); k++){
-        if(dangerPointList.at(k).distance(_pt) == 0)
-        {
-            index = k;
-            break;
-        }
+//----------------------------------DistanceField----------------------------------------------------------
+// turns from a set of cells to every cell, a turn moves up to MOVE_RANGE and a dig reaches DIG_RANGE
+struct DistanceField {
+    static constexpr int8_t UNREACHABLE = INT8_MAX;
+    array<int8_t, MAX_WIDTH * MAX_HEIGHT> stand;  // turns to stop on the cell
+    array<int8_t, MAX_WIDTH * MAX_HEIGHT> dig;    // turns to stop in dig range and dig it
+
+    // ring by ring, no turn ends on a blocked cell except the sources
+    void build(const Bitboard& sources, const Bitboard& blocked){
+        PROFILE_COUNT(Counter::DISTANCE_BUILD);
+        stand.fill(UNREACHABLE);
+        dig.fill(UNREACHABLE);
+        Bitboard open = ~blocked | sources;
+        Bitboard reached = sources & Bitboard::full();
+        Bitboard stood, dug;
+        for(int turns = 0; turns < UNREACHABLE - 1; turns++){
+            Bitboard digRange = reached.dilate(DIG_RANGE);
+            reached.andNot(stood).forEach([&](Point p){ stand.at(Bitboard::index(p.x, p.y)) = turns; });
+            digRange.andNot(dug).forEach([&](Point p){ dig.at(Bitboard::index(p.x, p.y)) = turns + 1; });
+            stood = reached;
+            dug = digRange;
+            reached = reached.dilate(MOVE_RANGE) & open;
+            if(reached == stood) break;
+        }
+    }
+    int standTurns(Point p) const { return Bitboard::inside(p.x, p.y) ? stand.at(Bitboard::index(p.x, p.y)) : UNREACHABLE; }
+    int digTurns(Point p) const { return Bitboard::inside(p.x, p.y) ? dig.at(Bitboard::index(p.x, p.y)) : UNREACHABLE; }
+    // fewest turns first, the walk breaks the ties inside a turn
+    static int order(int turns, int distance){ return turns * (MAX_WIDTH + MAX_HEIGHT) + distance; }
+};
+
+// fields from the base column and from each of our robots, built on first read
+// and dropped when the turn or the obstacles change
+struct DistanceFields {
+    int turn{-1};
+    Bitboard blocked;
+    array<Point, MAX_ROBOTS> robotPos;
+    array<bool, MAX_ROBOTS + 1> built{};  // robots then base
+    DistanceField baseField;
+    array<DistanceField, MAX_ROBOTS> robotFields;
+
+    DistanceFields& follow(Player& me, int _turn, const Bitboard& _blocked){
+        if(turn == _turn && blocked == _blocked)
+            return *this;
+        turn = _turn;
+        blocked = _blocked;
+        for(int i = 0; i < MAX_ROBOTS; i++)
+            robotPos.at(i) = me.robots.at(i);
+        built.fill(false);
+        return *this;
+    }
+    const DistanceField& base(){
+        if(!built.at(MAX_ROBOTS)){
+            baseField.build(Bitboard::column(0), blocked);
+            built.at(MAX_ROBOTS) = true;
+        }
+        return baseField;
+    }
+    const DistanceField& robot(int id){
+        if(!built.at(id)){
+            Bitboard at;
+            at.set(robotPos.at(id));
+            robotFields.at(id).build(at, blocked);
+            built.at(id) = true;
+        }
+        return robotFields.at(id);
     }
-    if(index != -1) 
-        dangerPointList.erase(dangerPointList.begin() + index); // release point
-}
+};
 
-void InsertHolePt(Point _pt){
-    // this tile is cause by enemy 100%
-    bool exist = false;
-    for(int k = 0; k < holePointList.size(); k++){
-        if(holePointList.at(k).distance(_pt) == 0)
-        {
-            exist = true;
-            break;
-        }
+//----------------------------------SearchBudget----------------------------------------------------------
+struct SearchBudget {
+    static constexpr double TURN_MS = 45;
+    static constexpr double FIRST_TURN_MS = 450;
+
+    bool enabled{false};  // off unless started on the clock or limited to a number of expansions
+    chrono::steady_clock::time_point deadline;
+    double turnMs{TURN_MS};  // clock budget of a turn after the first
+    int maxExpansions{INT32_MAX};  // a cap instead of the clock keeps offline matches reproducible
+
+    void start(chrono::steady_clock::time_point turnStart, int turn) {
+        enabled = true;
+        double ms = turn == 1 ? max(turnMs, FIRST_TURN_MS) : turnMs;
+        deadline = turnStart + chrono::microseconds((long long)(ms * 1000));
     }
-    if(!exist) 
-        holePointList.push_back(_pt); // mean something is here
+    // offline, a fixed number of expansions a turn and no clock: the same games on every run
+    void limit(int expansions) {
+        enabled = true;
+        maxExpansions = expansions;
+        deadline = chrono::steady_clock::time_point::max();
+    }
+    bool over(int expansions) const {
+        return !enabled || expansions >= maxExpansions || chrono::steady_clock::now() >= deadline;
+    }
+};
+
+//----------------------------------BotContext----------------------------------------------------------
+// one bot instance, everything getActions keeps between turns; bots share nothing so any number can run side by side
+struct BotContext : TurnMemory {
+    OreBelief oreBelief;
+    TrapBelief trapBelief;
+    SafetyMap safetyMap;
+    array<DistanceFields, 2> distanceFields;  // open board, unsafe cells blocked
+    SearchBudget searchBudget;
+    Params params;
+    bool destroyFirst{true};
+    bool noMinePlayer{false};
+};
+
+const Bitboard& UnsafeMask(BotContext& bot, Game& game, Player& me, Player& enemy, array<Action, MAX_ROBOTS>& actions){
+    return bot.safetyMap.follow(bot, game, me, enemy, actions);
 }
 
-void RemoveHolePt(Point _pt){
-    // this tile is cause by enemy 100%
-    int index = -1;
-    for(int k = 0; k < holePointList.size(); k++){
-        if(holePointList.at(k).distance(_pt) == 0)
-        {
-            index = k;
-            break;
-        }
-    }
-    if(index != -1) 
-        holePointList.erase(holePointList.begin() + index); // release point
+bool IsSafety(BotContext& bot, Game& game, Player& me, Player& enemy, array<Action, MAX_ROBOTS>& actions, Point _pt){
+    PROFILE_COUNT(Counter::IS_SAFETY);
+    if(!Bitboard::inside(_pt.x, _pt.y))
+        return ScanSafety(bot, game, me, enemy, actions, _pt, bot.dangerChains);
+    return !UnsafeMask(bot, game, me, enemy, actions).test(_pt);
 }
 
+// safe: a turn never ends on a cell IsSafety rejects
+DistanceFields& TurnDistances(BotContext& bot, Game& game, Player& me, Player& enemy, array<Action, MAX_ROBOTS>& actions, bool safe){
+    if(!safe)
+        return bot.distanceFields.at(0).follow(me, game.turn, Bitboard{});
+    return bot.distanceFields.at(1).follow(me, game.turn, UnsafeMask(bot, game, me, enemy, actions));
+}
 
 bool CheckExplosion(Game& game, Player& me, Player& enemy, Point _pt,int targetVictim=-1){
+    PROFILE_COUNT(Counter::CHECK_EXPLOSION);
     bool kamikaze = false;
     
-    vector<bool> myRobots(MAX_ROBOTS, false);
-    vector<bool> enemyRobots(MAX_ROBOTS, false);
+    array<bool, MAX_ROBOTS> myRobots{};
+    array<bool, MAX_ROBOTS> enemyRobots{};
     // if our robot beside bomb 
     
-    vector<Point> linkTraps;
-    
-    for(int j = 0; j < game.traps.size(); j++){
-        if(game.traps.at(j).distance(Point{_pt.x, _pt.y}) == 0){
-            // find all trap linked to this trap
-            linkTraps.push_back(game.traps.at(j));
-            LinkedTraps(linkTraps, game.traps, game.traps.at(j));
-            cerr << "linked:" << linkTraps.size() << "\n";
-        }
+    // all trap linked to this trap
+    int chain = game.trapChains.root(_pt);
+    Bitboard blast;
+    if(chain != -1){
+        blast = game.trapChains.blast(chain);
+        cerr << "linked:" << game.trapChains.size.at(chain) << "\n";
     }
     
     for(int i = 0; i < MAX_ROBOTS; i++){
-        for(int j = 0; j < linkTraps.size(); j++){
-            if(me.robots.at(i).distance(Point({linkTraps.at(j).x, linkTraps.at(j).y})) <= 1){
-                myRobots.at(i) = true;
-            }
-            if(enemy.robots.at(i).distance(Point({linkTraps.at(j).x, linkTraps.at(j).y})) <= 1){
-                enemyRobots.at(i) = true;
-            }
+        if(blast.test(me.robots.at(i))){
+            myRobots.at(i) = true;
+        }
+        if(blast.test(enemy.robots.at(i))){
+            enemyRobots.at(i) = true;
         }
         /*
-        for(int j = 0; j < dangerPointList.size(); j++){
-            if(dangerPointList.at(j).x == 1 && me.robots.at(i).distance(Point({dangerPointList.at(j).x, dangerPointList.at(j).y})) <= 1){
+        for(int j = 0; j < bot.dangerPointList.size(); j++){
+            if(bot.dangerPointList.at(j).x == 1 && me.robots.at(i).distance(Point({bot.dangerPointList.at(j).x, bot.dangerPointList.at(j).y})) <= 1){
                 myRobots.at(i) = true;
             }
-            if(dangerPointList.at(j).x == 1 && enemy.robots.at(i).distance(Point({dangerPointList.at(j).x, dangerPointList.at(j).y})) <= 1){
+            if(bot.dangerPointList.at(j).x == 1 && enemy.robots.at(i).distance(Point({bot.dangerPointList.at(j).x, bot.dangerPointList.at(j).y})) <= 1){
                 enemyRobots.at(i) = true;
             }
         }*/
@@ -586,21 +2121,22 @@ bool CheckExplosion(Game& game, Player& me, Player& enemy, Point _pt,int targetV
     return kamikaze;
 }
 
-Point SetMovePoint(Game& game, Player& me, array<Action, MAX_ROBOTS>& actions, Point _dest, int id){
+Point SetMovePoint(BotContext& bot, Game& game, Player& me, array<Action, MAX_ROBOTS>& actions, Point _dest, int id){
+    PROFILE_SCOPE(Phase::SET_MOVE_POINT);
+    Arena::Scope scope{game.arena};
     // if out of range 
-    vector<Point> candidateList;
+    Scratch<Point> candidateList{game.arena};
+    candidateList.reserve(Diamond<MOVE_RANGE>::SIZE);
         
     int minDist = -1;
     Point movePoint = Point{-1,-1};
-    for(int x = me.robots.at(id).x - 4; x <= me.robots.at(id).x + 4; x++){
-        for(int y = me.robots.at(id).y - 4; y <= me.robots.at(id).y + 4; y++){
-            if(me.robots.at(id).distance(Point{x,y})<=4){
-                candidateList.push_back(Point{x,y});
-            }
-        }
+    // off the board too, IsSafety turns those down
+    const Diamond<MOVE_RANGE>& reach = DIAMOND<MOVE_RANGE>;
+    for(int k = 0; k < reach.SIZE; k++){
+        candidateList.push_back(Point{me.robots.at(id).x + reach.dx[k], me.robots.at(id).y + reach.dy[k]});
     }
     for(int i = 0; i < candidateList.size(); i++){
-        bool isSafe = IsSafety(game.traps, me, game.players.at(1), actions, candidateList.at(i));
+        bool isSafe = IsSafety(bot, game, me, game.players.at(1), actions, candidateList.at(i));
         if(isSafe){
             if(minDist == -1){
                 movePoint = candidateList.at(i);
@@ -615,11 +2151,15 @@ Point SetMovePoint(Game& game, Player& me, array<Action, MAX_ROBOTS>& actions, P
     return movePoint;
 }
 
-void NewRadarPoint(Game& game, Player& me, array<Action, MAX_ROBOTS>& actions, int id, vector<Point> radarPointList){
+void NewRadarPoint(BotContext& bot, Game& game, Player& me, array<Action, MAX_ROBOTS>& actions, int id, const Scratch<Point>& radarPointList){
+    PROFILE_SCOPE(Phase::NEW_RADAR_POINT);
     // move to a highscore point
     int minDistance = -1;
     bool nearbyRadar = false;
     Point highPoint{0,0};
+    Bitboard radarCoverage = game.radarMask.dilate(4);
+    const DistanceField& field = TurnDistances(bot, game, me, game.players.at(1), actions, true).robot(id);
+    auto order = [&](Point p){ return DistanceField::order(field.digTurns(p), me.robots.at(id).distance(p)); };
     
     //cerr << "RadarPointList:" << radarPointList.size() << "\n";
     if(radarPointList.size() > 0){
@@ -636,64 +2176,56 @@ void NewRadarPoint(Game& game, Player& me, array<Action, MAX_ROBOTS>& actions, i
                 }
             }
             // check any nearby radar
-            nearbyRadar = CheckRadar(game.radars, Point{radarPointList.at(j).x,radarPointList.at(j).y});
-            bool isSafe = IsSafety(game.traps, me, game.players.at(1), actions, Point{radarPointList.at(j).x,radarPointList.at(j).y});
+            nearbyRadar = radarCoverage.test(radarPointList.at(j));
+            bool isSafe = IsSafety(bot, game, me, game.players.at(1), actions, Point{radarPointList.at(j).x,radarPointList.at(j).y});
             if(!someOneGoing && isSafe && !nearbyRadar && game.get(radarPointList.at(j).x,radarPointList.at(j).y).hole != true){
                 // check within range or not, if not return a middle point
                 if(minDistance == -1){
                     highPoint = Point{radarPointList.at(j).x, radarPointList.at(j).y};
-                    minDistance = me.robots.at(id).distance(highPoint);
+                    minDistance = order(highPoint);
                 }
-                if(me.robots.at(id).distance(Point{radarPointList.at(j).x, radarPointList.at(j).y}) < minDistance){
+                if(order(radarPointList.at(j)) < minDistance){
                     highPoint = Point{radarPointList.at(j).x, radarPointList.at(j).y};
-                    minDistance = me.robots.at(id).distance(highPoint);
+                    minDistance = order(highPoint);
                 }
             }
             //cerr << "nearbyRadar:" << nearbyRadar << " some1:" << someOneGoing << " Point x:" << radarPointList.at(j).x << " y:" << radarPointList.at(j).y << " min:"<< minDistance <<"\n";
         }
     }
     
-    actions.at(id).dig(highPoint, "OTW W/Radar");
+    actions.at(id).dig(highPoint, Message::OTW_RADAR);
+}
+
+// cells other robot standing on or going to
+Bitboard OthersTaken(Player& me, array<Action, MAX_ROBOTS>& actions, int id){
+    Bitboard taken;
+    for(int i=0; i < MAX_ROBOTS; i++){
+        if(i == id) continue;
+        taken.set(actions.at(i).dest);
+        taken.set(me.robots.at(i));
+    }
+    return taken;
 }
 
-Point NewDigPoint(Game& game, Player& me, array<Action, MAX_ROBOTS>& actions, int id, float highScore){
+Point NewDigPoint(BotContext& bot, Game& game, Player& me, array<Action, MAX_ROBOTS>& actions, int id){
+    PROFILE_SCOPE(Phase::NEW_DIG_POINT);
+    Arena::Scope scope{game.arena};
     // move to a highscore point
     int minDistance = -1;
-    bool trapFound = false;
-    bool dangerFlag = false;
-    bool isSafe = false;
-    bool enemyCloser = false;
-    bool speardOut = false;
-    vector<Point> candidateList;
-    vector<int> oreCountList;
+    Scratch<Point> candidateList{game.arena};
+    Scratch<int> oreCountList{game.arena};
+    candidateList.reserve(MAX_WIDTH*MAX_HEIGHT);
+    oreCountList.reserve(MAX_WIDTH*MAX_HEIGHT);
     Point digPoint{0,0};
+    Bitboard taken = OthersTaken(me, actions, id);
 
-    // if no valid hole
-    if(candidateList.size() <= 0){
-        // scan dig list
-        for(int j=0; j<game.digPointList.size(); j++){
-            // skip trap tile
-            trapFound = CheckTrap(game.traps, Point{game.digPointList.at(j).x,game.digPointList.at(j).y});
-            dangerFlag = IsDanger(Point{game.digPointList.at(j).x,game.digPointList.at(j).y});
-            isSafe = IsSafety(game.traps, me, game.players.at(1), actions, Point{game.digPointList.at(j).x,game.digPointList.at(j).y});
-            if(!trapFound && !dangerFlag && isSafe){
-                // check how many robot going
-                int count = 0;
-                for(int i=0; i < MAX_ROBOTS; i++){
-                    if(i == id) continue;
-                    if((game.digPointList.at(j).distance(Point{actions.at(i).dest.x,actions.at(i).dest.y}) == 0)||
-                        (me.robots.at(i).distance(game.digPointList.at(j)) == 0)){
-                        count++;
-                    }
-                }
-                // if still have vacancy go there
-                if(count <= 0){
-                    candidateList.push_back(Point{game.digPointList.at(j).x,game.digPointList.at(j).y});
-                    oreCountList.push_back(game.get(game.digPointList.at(j).x, game.digPointList.at(j).y).ore);
-                }
-            }
-        }
-    }
+    // scan dig list, skip trap/danger tile and tile someone going
+    Bitboard unsafe = UnsafeMask(bot, game, me, game.players.at(1), actions);
+    Bitboard freeOre = game.oreMask.andNot(game.trapMask).andNot(bot.dangerPointList.mask).andNot(taken).andNot(unsafe);
+    freeOre.forEach([&](Point p){
+        candidateList.push_back(p);
+        oreCountList.push_back(game.get(p).ore);
+    });
     
     if(candidateList.size() <= 0){
         // if someone with radar exist, x is ahead go to its dest
@@ -708,29 +2240,19 @@ Point NewDigPoint(Game& game, Player& me, array<Action, MAX_ROBOTS>& actions, in
         }
     }
     
+    // general tile for ore -1 with no hole and no one going
+    Bitboard blind = Bitboard::field().andNot(game.holeMask).andNot(game.knownMask).andNot(taken).andNot(unsafe);
+    
     // if still no valid candidate
     if(candidateList.size() <= 0){
-        // scan general tile for ore -1 with no hole with high score
-        float score = 0;
+        // scan general tile with high expected ore
+        float highOre = 0;
+        blind.forEach([&](Point p){ highOre = max(highOre, bot.oreBelief.expected(p)); });
         for(int x = 1; x < MAX_WIDTH; x++){
             for(int y = 0; y < MAX_HEIGHT; y++){
-                score = game.get(x,y).score + AdditionalRadarScore(game, Point{x,y});
-                isSafe = IsSafety(game.traps, me, game.players.at(1), actions, Point{x,y});
-                if(score > highScore*0.90 && isSafe && game.get(x,y).hole != true && game.get(x,y).ore == -1){
-                    // check how many robot going
-                    bool someoneGoing = false;
-                    for(int i=0; i < MAX_ROBOTS; i++){
-                        if(i == id) continue;
-                        if((game.get(x,y).distance(Point{actions.at(i).dest.x,actions.at(i).dest.y}) == 0)||
-                            (me.robots.at(i).distance(game.get(x,y)) == 0)){
-                            someoneGoing = true;
-                        }
-                    }
-                    if(!someoneGoing){
-                        candidateList.push_back(Point{x,y});
-                        oreCountList.push_back(game.get(x,y).ore);
-                    }
-                }
+                if(!blind.test(x,y) || bot.oreBelief.expected(Point{x,y}) <= highOre*bot.params.blindKeep) continue;
+                candidateList.push_back(Point{x,y});
+                oreCountList.push_back(game.get(x,y).ore);
             }
         }
     }
@@ -738,40 +2260,26 @@ Point NewDigPoint(Game& game, Player& me, array<Action, MAX_ROBOTS>& actions, in
     
     // if still no valid candidate
     if(candidateList.size() <= 0){
-        // scan general tile for ore -1 with no hole with high score
-        int tileCount = 0;
+        // scan general tile
         for(int x = 1; x < MAX_WIDTH; x++){
             for(int y = 0; y < MAX_HEIGHT; y++){
-                isSafe = IsSafety(game.traps, me, game.players.at(1), actions, Point{x,y});
-                if(game.get(x,y).hole != true && isSafe && game.get(x,y).ore == -1){
-                    // check how many robot going
-                    bool someoneGoing = false;
-                    for(int i=0; i < MAX_ROBOTS; i++){
-                        if(i == id) continue;
-                        if((game.get(x,y).distance(Point{actions.at(i).dest.x,actions.at(i).dest.y}) == 0)||
-                            (me.robots.at(i).distance(game.get(x,y)) == 0)){
-                            someoneGoing = true;
-                        }
-                    }
-                    if(!someoneGoing){
-                        candidateList.push_back(Point{x,y});
-                        oreCountList.push_back(game.get(x,y).ore);
-                    }
-                    tileCount++;
-                }
+                if(!blind.test(x,y)) continue;
+                candidateList.push_back(Point{x,y});
+                oreCountList.push_back(game.get(x,y).ore);
             }
         }
     }
   
     // if not carry anything
+    const DistanceField& field = TurnDistances(bot, game, me, game.players.at(1), actions, true).robot(id);
+    auto order = [&](Point p){ return DistanceField::order(field.digTurns(p), me.robots.at(id).distance(p)); };
     for(int j=0; j<candidateList.size(); j++){
         if(minDistance == -1) {
-            //highScore = game.get(Point({game.digPointList.at(j).x, game.digPointList.at(j).y})).score;
-            minDistance = me.robots.at(id).distance(candidateList.at(j));
+            minDistance = order(candidateList.at(j));
             digPoint = Point({candidateList.at(j).x, candidateList.at(j).y});
         }
-        if(me.robots.at(id).distance(candidateList.at(j)) < minDistance){
-            minDistance = me.robots.at(id).distance(candidateList.at(j));
+        if(order(candidateList.at(j)) < minDistance){
+            minDistance = order(candidateList.at(j));
             digPoint = Point({candidateList.at(j).x, candidateList.at(j).y});
         }
     }
@@ -781,71 +2289,185 @@ Point NewDigPoint(Game& game, Player& me, array<Action, MAX_ROBOTS>& actions, in
     return digPoint;
 }
 
-void NewTrapPoint(Game& game, Player& me, Player& enemy, array<Action, MAX_ROBOTS>& actions, int id){
+// min cost matching of every row to a column of its own, rows <= columns (Hungarian, O(rows^2 columns));
+// cost is row major, m columns a row, the match comes out of the caller arena scope
+Scratch<int> MinCostAssignment(Arena& arena, const Scratch<int>& cost, int n, int m){
+    const int INF = INT32_MAX / 2;
+    Scratch<int> u(n + 1, 0, arena), v(m + 1, 0, arena), p(m + 1, 0, arena), way(m + 1, 0, arena);
+    Scratch<int> minv(m + 1, INF, arena);
+    Scratch<char> used(m + 1, false, arena);
+    for(int i = 1; i <= n; i++){
+        p.at(0) = i;
+        int j0 = 0;
+        fill(minv.begin(), minv.end(), INF);
+        fill(used.begin(), used.end(), false);
+        do{
+            used.at(j0) = true;
+            int i0 = p.at(j0), delta = INF, j1 = 0;
+            for(int j = 1; j <= m; j++){
+                if(used.at(j)) continue;
+                int cur = cost.at((i0 - 1) * m + j - 1) - u.at(i0) - v.at(j);
+                if(cur < minv.at(j)){
+                    minv.at(j) = cur;
+                    way.at(j) = j0;
+                }
+                if(minv.at(j) < delta){
+                    delta = minv.at(j);
+                    j1 = j;
+                }
+            }
+            for(int j = 0; j <= m; j++){
+                if(used.at(j)){
+                    u.at(p.at(j)) += delta;
+                    v.at(j) -= delta;
+                }
+                else minv.at(j) -= delta;
+            }
+            j0 = j1;
+        } while(p.at(j0) != 0);
+        do{
+            int j1 = way.at(j0);
+            p.at(j0) = p.at(j1);
+            j0 = j1;
+        } while(j0 != 0);
+    }
+    Scratch<int> match(n, -1, arena);
+    for(int j = 1; j <= m; j++){
+        if(p.at(j) != 0) match.at(p.at(j) - 1) = j - 1;
+    }
+    return match;
+}
+
+// dig cell of every empty handed robot still READY, solved at once before the decision loop;
+// Point{-1,-1} when the visible ore runs out before the robot
+array<Point, MAX_ROBOTS> PlanDigPoints(BotContext& bot, Game& game, Player& me, Player& enemy, array<Action, MAX_ROBOTS>& actions){
+    PROFILE_SCOPE(Phase::NEW_DIG_POINT);
+    static constexpr int BLOCKED = 1 << 20;
+    Arena::Scope scope{game.arena};
+    array<Point, MAX_ROBOTS> plan;
+    Scratch<int> miners{game.arena};
+    miners.reserve(MAX_ROBOTS);
+    Bitboard taken;
+    for(int i = 0; i < MAX_ROBOTS; i++){
+        if(!me.robots.at(i).isDead() && me.robots.at(i).item == Type::NONE && actions.at(i).message == Message::READY)
+            miners.push_back(i);
+        else if(actions.at(i).type == ActionType::DIG)
+            taken.set(actions.at(i).dest);
+    }
+    int n = miners.size();
+    if(n == 0) return plan;
+
+    // one miner a cell, more would read as enemy digging in the ore analysis next turn
+    Bitboard unsafe = UnsafeMask(bot, game, me, enemy, actions);
+    Bitboard freeOre = game.oreMask.andNot(game.trapMask).andNot(bot.dangerPointList.mask).andNot(taken).andNot(unsafe);
+    Scratch<Point> slots{game.arena};
+    slots.reserve(freeOre.count());
+    freeOre.forEach([&](Point p){ slots.push_back(p); });
+
+    // cost is the walk out plus a share of the walk back (x is the distance to base),
+    // nobody takes the cell another robot stands on like NewDigPoint;
+    // ties keep last turn target, a swap between equal plans only makes both robots zigzag
+    auto pairCost = [&](int id, Point p){
+        for(int other = 0; other < MAX_ROBOTS; other++){
+            if(other != id && me.robots.at(other).distance(p) == 0) return BLOCKED;
+        }
+        bool kept = bot.prevActions.at(id).type == ActionType::DIG && bot.prevActions.at(id).dest.distance(p) == 0;
+        return 4 * me.robots.at(id).distance(p) + p.x - kept;
+    };
+    // only the n cheapest of each miner can be in an optimal matching
+    Scratch<char> keep(slots.size(), false, game.arena);
+    Scratch<int> order{game.arena};
+    order.reserve(slots.size());
+    for(int id : miners){
+        order.clear();
+        for(int s = 0; s < (int)slots.size(); s++){
+            if(pairCost(id, slots.at(s)) < BLOCKED) order.push_back(s);
+        }
+        int nearest = min(n, (int)order.size());
+        partial_sort(order.begin(), order.begin() + nearest, order.end(), [&](int a, int b){
+            return pairCost(id, slots.at(a)) < pairCost(id, slots.at(b));
+        });
+        for(int k = 0; k < nearest; k++) keep.at(order.at(k)) = true;
+    }
+    Scratch<Point> columns{game.arena};
+    columns.reserve(slots.size());
+    for(int s = 0; s < (int)slots.size(); s++){
+        if(keep.at(s)) columns.push_back(slots.at(s));
+    }
+
+    int m = max((int)columns.size(), n);
+    Scratch<int> cost(n * m, BLOCKED, game.arena);
+    for(int r = 0; r < n; r++){
+        for(int c = 0; c < (int)columns.size(); c++) cost.at(r * m + c) = pairCost(miners.at(r), columns.at(c));
+    }
+    Scratch<int> match = MinCostAssignment(game.arena, cost, n, m);
+    for(int r = 0; r < n; r++){
+        if(cost.at(r * m + match.at(r)) < BLOCKED) plan.at(miners.at(r)) = columns.at(match.at(r));
+    }
+    return plan;
+}
+
+// planned cell unless a robot decided earlier in the loop took it or made it unsafe, NewDigPoint then
+Point PlannedDigPoint(BotContext& bot, Game& game, Player& me, array<Action, MAX_ROBOTS>& actions, int id, const array<Point, MAX_ROBOTS>& plan){
+    Point p = plan.at(id);
+    if(p.x != -1 && !OthersTaken(me, actions, id).test(p) && IsSafety(bot, game, me, game.players.at(1), actions, p))
+        return p;
+    return NewDigPoint(bot, game, me, actions, id);
+}
+
+void NewTrapPoint(BotContext& bot, Game& game, Player& me, Player& enemy, array<Action, MAX_ROBOTS>& actions, int id){
+    PROFILE_SCOPE(Phase::NEW_TRAP_POINT);
+    Arena::Scope scope{game.arena};
     // check outside x = 1
-    bool dangerFlag = false;
-    bool trapFound = false;
-    bool isSafe = false;
-    bool otherGoing = false;
-    bool noEnemyBeside = false;
-    vector<Point> candidateList;
+    Scratch<Point> candidateList{game.arena};
+    candidateList.reserve(MAX_WIDTH*MAX_HEIGHT);
     Point _p{-1,-1};
     int minY = -1;
-    int newCont = -1;
     int wall = 1;
+    // no other robot beside
+    Bitboard otherNear = OthersTaken(me, actions, id).dilate(1);
+    Bitboard unsafe = UnsafeMask(bot, game, me, enemy, actions);
+    const DistanceField& field = TurnDistances(bot, game, me, enemy, actions, true).robot(id);
+    auto order = [&](Point p){ return DistanceField::order(field.digTurns(p), me.robots.at(id).distance(p)); };
     // priority set up first
     // 1, 3, 5, 7, 9, 11,13
-    while(_p.x == -1){
-        for(int y=2; y<MAX_HEIGHT-3; y++){
-            dangerFlag = IsDanger(Point{wall, y});
-            trapFound = CheckTrap(game.traps, Point{wall, y});
-            isSafe = IsSafety(game.traps, me, enemy, actions, Point{wall,y});
-            
-            otherGoing = false;
-            for(int i=0; i<MAX_ROBOTS; i++){
-                if(id == i) continue;
-                if(actions.at(i).dest.distance(Point{wall,y}) <= 1||me.robots.at(i).distance(Point{wall,y}) <= 1)
-                    otherGoing = true;
-            }
-            noEnemyBeside = false;
-            for(int i=0; i<MAX_ROBOTS; i++){
-                if(enemy.robots.at(i).distance(Point{wall,y}) <= 1)
-                    noEnemyBeside = true;
-            }
-            if(me.robots.at(id).item == Type::TRAP){
-                if(!dangerFlag && !trapFound && !otherGoing && isSafe){
-                    candidateList.push_back(Point{wall,y});
-                }
-            }
-            else{
-                if(!dangerFlag && !trapFound && !otherGoing && isSafe && game.get(wall,y).hole != true){
-                    candidateList.push_back(Point{wall,y});
-                }
-            }
-        }
+    while(_p.x == -1 && wall < MAX_WIDTH){
+        Bitboard free = Bitboard::segment(wall, 2, MAX_HEIGHT-3).andNot(bot.dangerPointList.mask).andNot(game.trapMask).andNot(otherNear).andNot(unsafe);
+        if(me.robots.at(id).item != Type::TRAP){
+            free = free.andNot(game.holeMask);
+        }
+        free.forEach([&](Point p){
+            candidateList.push_back(p);
+        });
     
         for(int i=0; i < candidateList.size(); i++){
             if(minY == -1){
                 _p = candidateList.at(i);
-                minY = me.robots.at(id).distance(_p);
+                minY = order(_p);
             }
-            if(me.robots.at(id).distance(candidateList.at(i)) < minY){
+            if(order(candidateList.at(i)) < minY){
                 _p = candidateList.at(i);
-                minY = me.robots.at(id).distance(_p);
+                minY = order(_p);
             }
         }
         wall++;
     }
     
-    actions.at(id).dig(_p, "DIG TRAP");
+    if(_p.x != -1){
+        actions.at(id).dig(_p, Message::DIG_TRAP);
+    }
 }
 
-void MoveBack(Game& game, Player& me, array<Action, MAX_ROBOTS>& actions, int id, Type _type){
-    vector<Point> candidateList;
+void MoveBack(BotContext& bot, Game& game, Player& me, array<Action, MAX_ROBOTS>& actions, int id, Type _type){
+    PROFILE_SCOPE(Phase::MOVE_BACK);
+    Arena::Scope scope{game.arena};
+    Scratch<Point> candidateList{game.arena};
+    candidateList.reserve(MAX_HEIGHT);
     int minDist = -1;
     Point homePoint = Point{-1,-1};
+    const DistanceField& field = TurnDistances(bot, game, me, game.players.at(1), actions, true).robot(id);
     for(int y=0;y<MAX_HEIGHT;y++){
-        bool isSafe = IsSafety(game.traps, me, game.players.at(1), actions, Point{0, y});
+        bool isSafe = IsSafety(bot, game, me, game.players.at(1), actions, Point{0, y});
         if(isSafe)
         {
             candidateList.push_back(Point{0,y});
@@ -853,6 +2475,7 @@ void MoveBack(Game& game, Player& me, array<Action, MAX_ROBOTS>& actions, int id
     }
     for(int z=0; z<candidateList.size(); z++)
     {
+        // first safe cell from the top, the base cell fewest turns away lost about 2 ore a game head to head
         if(minDist == -1) {
             homePoint = candidateList.at(z);
             minDist = candidateList.at(z).distance(homePoint);
@@ -862,29 +2485,29 @@ void MoveBack(Game& game, Player& me, array<Action, MAX_ROBOTS>& actions, int id
             minDist = candidateList.at(z).distance(homePoint);
         }
     }
-    if(homePoint.distance(me.robots.at(id)) >4)
+    if(field.standTurns(homePoint) > 1)
     {
-        Point thisPt = SetMovePoint(game, me, actions, homePoint, id);
+        Point thisPt = SetMovePoint(bot, game, me, actions, homePoint, id);
         if(thisPt.x != -1){
-            actions.at(id).move(thisPt, "GO HOME");
+            actions.at(id).move(thisPt, Message::GO_HOME);
         }
         else{
-            bool isSafe = IsSafety(game.traps, me, game.players.at(1), actions, me.robots.at(id));
+            bool isSafe = IsSafety(bot, game, me, game.players.at(1), actions, me.robots.at(id));
             if(isSafe)
-                actions.at(id).wait("Wait HOME");
+                actions.at(id).wait(Message::WAIT_HOME);
             else
             {
                 for(int x=me.robots.at(id).x-4; x <= me.robots.at(id).x+4; x++){
                     if(x < 0) continue;
-                    bool newSafe = IsSafety(game.traps, me, game.players.at(1), actions, Point{x, me.robots.at(id).y});
+                    bool newSafe = IsSafety(bot, game, me, game.players.at(1), actions, Point{x, me.robots.at(id).y});
                     if(newSafe)
-                        actions.at(id).move(Point{x, me.robots.at(id).y}, "Evade!");
+                        actions.at(id).move(Point{x, me.robots.at(id).y}, Message::EVADE);
                     else{
                         for(int y=me.robots.at(id).y-4; y < me.robots.at(id).y+4; y++){
                             if(y < 0||y >= MAX_HEIGHT-1) continue; 
-                            newSafe = IsSafety(game.traps, me, game.players.at(1), actions, Point{me.robots.at(id).x, y});
+                            newSafe = IsSafety(bot, game, me, game.players.at(1), actions, Point{me.robots.at(id).x, y});
                             if(newSafe)
-                                actions.at(id).move(Point{me.robots.at(id).x, y}, "Evade!");
+                                actions.at(id).move(Point{me.robots.at(id).x, y}, Message::EVADE);
                         }
                     }
                 }
@@ -895,260 +2518,186 @@ void MoveBack(Game& game, Player& me, array<Action, MAX_ROBOTS>& actions, int id
     else
     {
         if(_type == Type::RADAR){
-            actions.at(id).request(Type::RADAR, "GO HOME URGENT");
+            actions.at(id).request(Type::RADAR, Message::GO_HOME_URGENT);
         }
         else{
-            actions.at(id).move(homePoint, "GO HOME");
+            actions.at(id).move(homePoint, Message::GO_HOME);
         }
     }
 }
 
-//*********************************  AI  *****************************************************************
-bool destroyFirst = true;
-bool noMinePlayer = false;
+//*********************************  PLAN SEARCH  *****************************************************************
+// the greedy pass picks robot after robot, the search rethinks the joint dig plan of the free miners
+// until the turn budget runs out; the greedy plan stays the answer unless a plan scores better
+
+// turns for robot id to stand beside _pt, dig it, and walk the ore home
+int TripTurns(DistanceFields& fields, int id, Point _pt){
+    return fields.robot(id).digTurns(_pt) + fields.base().standTurns(_pt);
+}
+
+// free miners: empty handed, sent to an ordinary dig by the greedy pass
+bool Searchable(Player& me, array<Action, MAX_ROBOTS>& actions, int id){
+    return !me.robots.at(id).isDead() && me.robots.at(id).item == Type::NONE &&
+        actions.at(id).type == ActionType::DIG && actions.at(id).message == Message::OTW;
+}
+
+// expected ore per turn of the free miners, ore of a cell shared first come first served
+double PlanValue(BotContext& bot, Game& game, array<Action, MAX_ROBOTS>& actions, const array<bool, MAX_ROBOTS>& free, const Bitboard& unsafe, DistanceFields& fields){
+    static constexpr double UNKNOWN_ORE = 0.3;  // blind dig
+    array<int, MAX_ROBOTS> claimed{};
+    double value = 0;
+    for(int pass = 0; pass < 2; pass++){
+        // others first, their digs are not up for discussion
+        for(int i = 0; i < MAX_ROBOTS; i++){
+            if(free.at(i) != (pass == 1) || actions.at(i).type != ActionType::DIG) continue;
+            Point p = actions.at(i).dest;
+            int before = 0;
+            for(int j = 0; j < MAX_ROBOTS; j++)
+                before += claimed.at(j) && actions.at(j).dest.distance(p) == 0;
+            claimed.at(i) = 1;
+            if(pass == 0 || !Bitboard::inside(p.x, p.y)) continue;
+            if(unsafe.test(p) || game.trapMask.test(p) || bot.isDanger(p)){
+                value -= 1;
+                continue;
+            }
+            Cell cell = game.get(p);
+            double gain = cell.ore > before ? 1 : (cell.ore == -1 && !cell.hole ? UNKNOWN_ORE : 0);
+            value += gain / TripTurns(fields, i, p);
+        }
+    }
+    return value;
+}
+
+array<Action, MAX_ROBOTS> SearchPlan(BotContext& bot, Game& game, Player& me, Player& enemy, const array<Action, MAX_ROBOTS>& greedy){
+    PROFILE_SCOPE(Phase::PLAN_SEARCH);
+    static constexpr int CANDIDATES = 6;
+    static constexpr int BEAM_WIDTH = 8;
+    struct Plan {
+        array<Action, MAX_ROBOTS> actions;
+        double value;
+    };
+    Plan best{greedy, 0};
+    if(!bot.searchBudget.enabled) return greedy;
+
+    Arena::Scope scope{game.arena};
+    array<bool, MAX_ROBOTS> free{};
+    Scratch<Scratch<Action>> choices(MAX_ROBOTS, Scratch<Action>{game.arena}, game.arena);
+    DistanceFields& fields = TurnDistances(bot, game, me, enemy, best.actions, false);
+    Bitboard ore = game.oreMask.andNot(game.trapMask).andNot(bot.dangerPointList.mask);
+    Scratch<Point> cells{game.arena};
+    cells.reserve(ore.count());
+    for(int i = 0; i < MAX_ROBOTS; i++){
+        free.at(i) = Searchable(me, best.actions, i);
+        if(!free.at(i)) continue;
+        choices.at(i).reserve(CANDIDATES);
+        // nearest round trips first
+        cells.clear();
+        ore.forEach([&](Point p){ cells.push_back(p); });
+        int keep = min((int)cells.size(), CANDIDATES);
+        partial_sort(cells.begin(), cells.begin() + keep, cells.end(), [&](const Point& a, const Point& b){
+            return TripTurns(fields, i, a) < TripTurns(fields, i, b);
+        });
+        for(int k = 0; k < keep; k++){
+            if(cells.at(k).distance(greedy.at(i).dest) == 0) continue;
+            Action action;
+            action.dig(cells.at(k), Message::OTW);
+            choices.at(i).push_back(action);
+        }
+    }
 
-array<Action, MAX_ROBOTS> getActions(Game& game) {
+    // unsafe as the robots that keep their action see it, free miners standing still
+    array<Action, MAX_ROBOTS> scratch = greedy;
+    for(int i = 0; i < MAX_ROBOTS; i++)
+        if(free.at(i)) scratch.at(i).move(me.robots.at(i));
+    Bitboard unsafe = UnsafeMask(bot, game, me, enemy, scratch);
+    best.value = PlanValue(bot, game, best.actions, free, unsafe, fields);
+    double greedyValue = best.value;
+    Scratch<Plan> beam{game.arena}, layer{game.arena};
+    beam.reserve(BEAM_WIDTH);
+    layer.reserve(BEAM_WIDTH * MAX_ROBOTS * CANDIDATES);
+    beam.push_back(best);
+    int expansions = 0;
+    while(!bot.searchBudget.over(expansions)){
+        // every plan one robot away from the beam
+        layer.clear();
+        for(Plan& plan : beam){
+            for(int i = 0; i < MAX_ROBOTS; i++){
+                for(Action& choice : choices.at(i)){
+                    if(plan.actions.at(i).dest.distance(choice.dest) == 0 || bot.searchBudget.over(expansions)) continue;
+                    Plan next = plan;
+                    next.actions.at(i) = choice;
+                    next.value = PlanValue(bot, game, next.actions, free, unsafe, fields);
+                    expansions++;
+                    layer.push_back(next);
+                }
+            }
+        }
+        sort(layer.begin(), layer.end(), [](const Plan& a, const Plan& b){ return a.value > b.value; });
+        // same digs reached in another order
+        auto same = [](const Plan& a, const Plan& b){
+            for(int i = 0; i < MAX_ROBOTS; i++)
+                if(a.actions.at(i).dest.distance(b.actions.at(i).dest) != 0) return false;
+            return true;
+        };
+        beam.clear();
+        for(Plan& plan : layer){
+            if((int)beam.size() == BEAM_WIDTH) break;
+            if(none_of(beam.begin(), beam.end(), [&](const Plan& kept){ return same(kept, plan); }))
+                beam.push_back(plan);
+        }
+        if(beam.empty() || beam.front().value <= best.value + 1e-9) break;
+        best = beam.front();
+    }
+    cerr << "search " << expansions << " plans, value " << greedyValue << " -> " << best.value << "\n";
+    // leave the safety map following the chosen destinations
+    UnsafeMask(bot, game, me, enemy, best.actions);
+    return best.actions;
+}
+
+//*********************************  AI  *****************************************************************
+array<Action, MAX_ROBOTS> getActions(BotContext& bot, Game& game) {
+    PROFILE_TURN(game.turn);
+    Arena::Scope scope{game.arena};
+    game.trapChains.sync(game.trapMask);
     array<Action, MAX_ROBOTS> actions;
     Player& me{game.players.at(0)};
     Player& enemy{game.players.at(1)};
     
     //*********************************  ORE & new hole Analysis  *****************************************************************
-    // for orereducelist and newholelist that cause by us remove it
-    vector<int> cleanUp;
-    cleanUp.clear();
-    for(int j = 0; j < game.oreReduceList.size(); j++){
-        // is our robot dig here
-        int index = -1;
-        for(int k = 0; k < MAX_ROBOTS; k++){
-            // previous action dig here and robot now beside here
-            if(prevActions.at(k).dest.distance(game.oreReduceList.at(j)) == 0 && prevActions.at(k).type == ActionType::DIG &&
-                me.robots.at(k).distance(game.oreReduceList.at(j)) <= 1 && me.robots.at(k).distance(prevOurPos.at(k)) == 0){
-                index = j;
-                break;
-            }
-        }
-        if(index != -1) 
-            cleanUp.push_back(index);
-    }
-    // remove item in clean up
-    for(int j = 0; j < cleanUp.size(); j++){
-        game.oreReduceList.erase(game.oreReduceList.begin()+cleanUp.at(j));
-    }
+    // holes and ore changes tagged ours or enemy, robot pauses and returns, the beliefs read only these
+    ClassifyEvents(bot, game);
     
-    cleanUp.clear();
-    for(int j = 0; j < game.newHoleList.size(); j++){
-        // is our robot dig here
-        int index = -1;
-        for(int k = 0; k < MAX_ROBOTS; k++){
-            // previous action dig here and robot now beside here
-            if(prevActions.at(k).dest.distance(game.newHoleList.at(j)) == 0 && prevActions.at(k).type == ActionType::DIG &&
-                me.robots.at(k).distance(game.newHoleList.at(j)) <= 1 && me.robots.at(k).distance(prevOurPos.at(k)) == 0){
-                index = j;
-                break;
-            }
-        }
-        if(index != -1) 
-            cleanUp.push_back(index);
-    }
-    // remove item in clean up
-    for(int j = 0; j < cleanUp.size(); j++){
-        game.newHoleList.erase(game.newHoleList.begin()+cleanUp.at(j));
-    }
+    bot.oreBelief.update(game, me);
     
     //*********************************  Enemy Analysis  *****************************************************************
-    // compare Enemy position to prev
-    for(int i = 0; i < MAX_ROBOTS; i++){
-        // it spend 1 turn at home not moving, might get radar or trap or fraud, put into suspect
-        if(enemy.robots.at(i).distance(prevEnemyPos.at(i)) == 0 && enemy.robots.at(i).x == 0 && !suspectID.at(i)){
-            suspectID.at(i) = true;
-            if(suspectID.at(i))
-                cerr << "SuspectID:" << i << " added\n";
-        }
-        else if(enemy.robots.at(i).distance(prevEnemyPos.at(i)) == 0 && enemy.robots.at(i).x == 0 && suspectID.at(i)){
-             for(int j = 0; j < game.newHoleList.size(); j++){
-                // if enemy around the new hole
-                if(enemy.robots.at(i).distance(game.newHoleList.at(j)) <= 1){
-                    // is our robot dig here
-                    bool digHere = false;
-                    for(int k = 0; k < MAX_ROBOTS; k++){
-                        // previous action dig here and robot now stop here 1turn
-                        if(prevActions.at(k).dest.distance(game.newHoleList.at(j)) == 0 && prevActions.at(k).type == ActionType::DIG &&
-                            me.robots.at(k).distance(game.newHoleList.at(j)) <= 1 && me.robots.at(k).distance(prevOurPos.at(k)) == 0){
-                            digHere = true;
-                            break;
-                        }
-                    }
-                    
-                    // if our robot didn't dig here
-                    if(!digHere){
-                        InsertDangerPt(game.newHoleList.at(j)); // trap or radar here
-                        suspectID.at(i) = false; // drop suspect
-                        cerr << "SuspectID:" << i << " dropped\n";
-                    }
-                }
-            }
-        }
-        if(enemy.robots.at(i).distance(prevEnemyPos.at(i)) != 0 && prevEnemyPos.at(i).x > 0 && enemy.robots.at(i).x == 0){
-            suspectID.at(i) = false;
-            cerr << "SuspectID:" << i << " dropped\n";
-        }
-        
-        // it suspect spend 1 turn outside not moving we want to know where he put trap/radar
-        if(enemy.robots.at(i).distance(prevEnemyPos.at(i)) == 0 && enemy.robots.at(i).x > 0 && suspectID.at(i)){
-            // what happen to up/down/left/right/center
-            for(int x = enemy.robots.at(i).x-1; x <= enemy.robots.at(i).x+1; x++){
-                for(int y = enemy.robots.at(i).y-1; y <= enemy.robots.at(i).y+1; y++){
-                    //up down left right center tile
-                    if(x-1 < 1 || x+1 >= MAX_WIDTH-1) continue;
-                    if(y-1 < 0 || y+1 >= MAX_HEIGHT-1) continue;
-                    if(enemy.robots.at(i).distance(Point{x,y}) <=1){
-                        // if not under our radar
-                        if(game.get(enemy.robots.at(i).x, enemy.robots.at(i).y).oreVisible != true){
-                            // if new hole appear here
-                            // if not our robot
-                            // if more than 1 enemy robot here
-                            // if no other robot stop nearby this adjacent tile
-                            for(int j = 0; j < game.newHoleList.size(); j++){
-                                // if enemy around the new hole
-                                if(enemy.robots.at(i).distance(game.newHoleList.at(j)) <= 1){
-                                    // is our robot dig here
-                                    bool digHere = false;
-                                    for(int k = 0; k < MAX_ROBOTS; k++){
-                                        // previous action dig here and robot now stop here 1turn
-                                        if(prevActions.at(k).dest.distance(game.newHoleList.at(j)) == 0 && prevActions.at(k).type == ActionType::DIG &&
-                                            me.robots.at(k).distance(game.newHoleList.at(j)) <= 1 && me.robots.at(k).distance(prevOurPos.at(k)) == 0){
-                                            digHere = true;
-                                            break;
-                                        }
-                                    }
-                                    
-                                    // if our robot didn't dig here
-                                    if(!digHere){
-                                        InsertDangerPt(game.newHoleList.at(j)); // trap or radar here
-                                        suspectID.at(i) = false; // drop suspect
-                                    }
-                                }
-                            }
-                        }
-                        else{
-                            // if new hole appear here
-                            // new hole list
-                            for(int j = 0; j < game.newHoleList.size(); j++){
-                                // if enemy around the new hole
-                                if(enemy.robots.at(i).distance(game.newHoleList.at(j)) <= 1){
-                                    // is our robot dig here
-                                    bool digHere = false;
-                                    for(int k = 0; k < MAX_ROBOTS; k++){
-                                        // previous action dig here and robot now stop here 1turn
-                                        if(prevActions.at(k).dest.distance(game.newHoleList.at(j)) == 0 && prevActions.at(k).type == ActionType::DIG &&
-                                            me.robots.at(k).distance(game.newHoleList.at(j)) <= 1 && me.robots.at(k).distance(prevOurPos.at(k)) == 0){
-                                            digHere = true;
-                                            break;
-                                        }
-                                    }
-                                    
-                                    // if our robot didn't dig here
-                                    if(!digHere){
-                                        InsertDangerPt(game.newHoleList.at(j)); // trap or radar here
-                                        suspectID.at(i) = false; // drop suspect
-                                    }
-                                }
-                            }
-                            
-                            // scan reduce list
-                            for(int j = 0; j < game.oreReduceList.size(); j++){
-                                // if enemy around the ore reduce tile
-                                if(enemy.robots.at(i).distance(game.oreReduceList.at(j)) <= 1){
-                                   // is our robot dig here last round
-                                    bool digHere = false;
-                                    for(int k = 0; k < MAX_ROBOTS; k++){
-                                        // previous action dig here and robot now stop here 1turn
-                                        if(prevActions.at(k).dest.distance(game.oreReduceList.at(j)) == 0 && prevActions.at(k).type == ActionType::DIG &&
-                                            me.robots.at(k).distance(game.oreReduceList.at(j)) <= 1 && me.robots.at(k).distance(prevOurPos.at(k)) == 0){
-                                            digHere = true;
-                                            break;
-                                        }
-                                    }
-                                    // if our robot not dig here last round
-                                    if(!digHere){
-                                        InsertDangerPt(game.oreReduceList.at(j));
-                                        suspectID.at(i) = false; // drop suspect
-                                    }
-                                }
-                            }
-                        }
-                        
-                    }
-                }
-            }
-                
-            // if still suspect all hole add to danger list
-            if(suspectID.at(i) == true){
-                for(int x = enemy.robots.at(i).x-1; x <= enemy.robots.at(i).x+1; x++){
-                    for(int y = enemy.robots.at(i).y-1; y <= enemy.robots.at(i).y+1; y++){
-                        //up down left right center tile
-                        if(x < 1 || x >= MAX_WIDTH-1) continue;
-                        if(y < 0 || y >= MAX_HEIGHT-1) continue;
-                        if(enemy.robots.at(i).distance(Point{x,y}) <=1){
-                            // those tile not under radar add to list
-                            bool inReduceList = false;
-                            for(int j = 0; j < game.oreReduceList.size(); j++){
-                                if(game.oreReduceList.at(j).distance(Point{x,y}) == 0){
-                                    inReduceList = true;
-                                }
-                            }
-                            bool inNewHoleList = false;
-                            for(int j = 0; j < game.newHoleList.size(); j++){
-                                if(game.newHoleList.at(j).distance(Point{x,y}) == 0){
-                                    inNewHoleList = true;
-                                }
-                            }
-                            if(game.get(x,y).oreVisible != true && !inNewHoleList){
-                                InsertDangerPt(Point{x,y});
-                            }
-                            if(game.get(x,y).oreVisible == true && game.get(x,y).hole == true && !inNewHoleList && !inReduceList){
-                                InsertDangerPt(Point{x,y});
-                            }
-                        }
-                    }
-                }
-            }
-        }
-    }
+    PROFILE_PHASE(Phase::ENEMY_ANALYSIS);
+    // enemy pauses, new holes and ore taken feed the trap belief, it keeps the danger list
+    bot.trapBelief.update(bot, game);
     //*********************************  MAP Analysis End *****************************************************************
     
     //*********************************  INIT START *****************************************************************
+    PROFILE_PHASE(Phase::ROBOT_DECISION);
     // init all actions
     for(int i = 0; i < MAX_ROBOTS; i++){
-        if(prevActions.at(i).message == "DESTROY" && me.robots.at(i).distance(prevOurPos.at(i)) != 0){
-            actions.at(i).dig(prevActions.at(i).dest, "DESTROY");
+        if(bot.prevActions.at(i).message == Message::DESTROY && me.robots.at(i).distance(bot.prevOurPos.at(i)) != 0){
+            actions.at(i).dig(bot.prevActions.at(i).dest, Message::DESTROY);
         }
-        else if(prevActions.at(i).message == "DESTROY" && me.robots.at(i).distance(prevOurPos.at(i)) == 0 && me.robots.at(i).distance(prevActions.at(i).dest) <= 1){
-            actions.at(i).wait("READY");
-            int index = -1;
-            for(int j = 0;  j < dangerPointList.size(); j++){
-                if(dangerPointList.at(j).distance(prevActions.at(i).dest) == 0){
-                    index = j;
-                }
-            }
-            if(index != -1){
-                dangerPointList.erase(dangerPointList.begin() + index);
-                cerr << "remove index:" << index << "\n";
-            }
+        else if(bot.prevActions.at(i).message == Message::DESTROY && me.robots.at(i).distance(bot.prevOurPos.at(i)) == 0 && me.robots.at(i).distance(bot.prevActions.at(i).dest) <= 1){
+            actions.at(i).wait(Message::READY);
         }
-        else if(prevActions.at(i).type == ActionType::WAIT && prevActions.at(i).message == "Gimme HOLE" && me.robots.at(i).x == 0){
+        else if(bot.prevActions.at(i).type == ActionType::WAIT && bot.prevActions.at(i).message == Message::GIMME_HOLE && me.robots.at(i).x == 0){
             // give him a hole
             me.robots.at(i).item = Type::HOLE;
             cerr << "Given HOLE \n";
-            game.fakeCD = 5;
-            actions.at(i).wait("READY");
+            game.fakeCD = bot.params.fakeCooldown;
+            actions.at(i).wait(Message::READY);
         }
-        else if(prevActions.at(i).type == ActionType::MOVE && prevActions.at(i).message == "OTW HOLE"){
+        else if(bot.prevActions.at(i).type == ActionType::MOVE && bot.prevActions.at(i).message == Message::OTW_HOLE){
             me.robots.at(i).item = Type::HOLE;
-            actions.at(i).wait("READY");
+            actions.at(i).wait(Message::READY);
         }
         else{
-            actions.at(i).wait("READY");
+            actions.at(i).wait(Message::READY);
         }
         if(me.robots.at(i).item == Type::HOLE){
             cerr << "ROBOT " << i << " holding hole\n";
@@ -1157,7 +2706,7 @@ array<Action, MAX_ROBOTS> getActions(Game& game) {
     for(int i = 0; i < MAX_ROBOTS; i++){
         // for robot dead
         if(me.robots.at(i).x == -1){
-            actions.at(i).wait("DEAD");
+            actions.at(i).wait(Message::DEAD);
         }
     }
     
@@ -1166,50 +2715,38 @@ array<Action, MAX_ROBOTS> getActions(Game& game) {
         cerr << "time to collect stuf!\n";
     }
     //*********************************  Radar Start  *****************************************************************
+    PROFILE_PHASE(Phase::RADAR_SCORE);
     // map visibility check any radar needed
     bool radarNeeded = false;
     bool radarUrgent = false;
     
     float highestScore = 0;
-    vector<Point> radarPointList;
-    for(int y = 0; y < MAX_HEIGHT; y++){
-        for(int x = 1; x < MAX_WIDTH; x++){
-            // check current highest score
-            float score = game.get(x,y).score + AdditionalRadarScore(game, Point{x,y});
-            bool nearbyRadar = CheckRadar(game.radars, Point{x,y});
-            // check any nearby radar
-            
-            if(score > highestScore && game.get(x,y).hole != true && !nearbyRadar)
-                highestScore = score;
-        }
-        //cerr << "\n";
-    }
+    Scratch<Point> radarPointList{game.arena};
+    radarPointList.reserve(MAX_WIDTH*MAX_HEIGHT);
+    // single pass, drop candidates falling under radarKeep each time the highest score rises
+    Bitboard radarFree = Bitboard::field().andNot(game.holeMask).andNot(game.radarMask.dilate(4));
+    radarFree.forEach([&](Point p){
+        float score = game.radarValue(p);
+        if(score <= highestScore*bot.params.radarKeep) return;
+        if(score > highestScore){
+            highestScore = score;
+            radarPointList.erase(remove_if(radarPointList.begin(), radarPointList.end(), [&](Point q){
+                return game.radarValue(q) <= highestScore*bot.params.radarKeep;
+            }), radarPointList.end());
+        }
+        radarPointList.push_back(p);
+    });
     cerr << "Highest Score: " << highestScore << "\n";
-    // all candidate that score within range 0.95
-    for(int y = 0; y < MAX_HEIGHT; y++){
-        for(int x = 1; x < MAX_WIDTH; x++){
-            // check current highest score
-            float score = game.get(x,y).score + AdditionalRadarScore(game, Point{x,y});
-            bool nearbyRadar = CheckRadar(game.radars, Point{x,y});
-            if(score > highestScore*0.95 && game.get(x,y).hole != true && !nearbyRadar)
-                radarPointList.push_back(Point{x,y});
-        }
-    }
     if(radarPointList.size() > 0)
         radarNeeded = true;
     
     // safe digPoint
-    int safePoint = 0;
-    for(int i=0; i<game.digPointList.size(); i++){
-        if(game.get(game.digPointList.at(i).x,game.digPointList.at(i).y).hole != true){
-            safePoint++;
-        }
-    }
-    if(safePoint <= 10 && radarNeeded){
+    int safePoint = game.oreMask.andNot(game.holeMask).count();
+    if(safePoint <= bot.params.radarUrgentOre && radarNeeded){
         radarUrgent = true;
     }
     
-    if(safePoint > 20){
+    if(safePoint > bot.params.radarEnoughOre){
         radarNeeded = false;
     }
     
@@ -1253,7 +2790,7 @@ array<Action, MAX_ROBOTS> getActions(Game& game) {
             }
             // if have a valid robot
             if(id != -1){
-                actions.at(id).request(Type::RADAR, "GIMME RADAR!");
+                actions.at(id).request(Type::RADAR, Message::GIMME_RADAR);
             }
             else{
                 // if this is a urgent request
@@ -1262,77 +2799,77 @@ array<Action, MAX_ROBOTS> getActions(Game& game) {
                     // find free robot that closest to base
                     for(int j = 0; j < MAX_ROBOTS; j++){
                         if((me.robots.at(j).item == Type::NONE||me.robots.at(j).item == Type::ORE) && me.robots.at(j).x > 0 &&
-                        actions.at(j).message != "DESTROY" && actions.at(j).item != Type::TRAP){
+                        actions.at(j).message != Message::DESTROY && actions.at(j).item != Type::TRAP){
                             if(id == -1) id = j;
                             if(me.robots.at(j).x < me.robots.at(id).x)
                                 id = j;
                         }
                     }
                     if(id != -1)
-                        MoveBack(game, me, actions, id, Type::RADAR);
+                        MoveBack(bot, game, me, actions, id, Type::RADAR);
                 }
             }
         }
     }
     
-    if(game.turn == 10){
-        cerr << dangerPointList.size() << " dangerPt!";
-        if(dangerPointList.size()<=2){
-            noMinePlayer = true;
+    if(game.turn == bot.params.noMineTurn){
+        cerr << bot.dangerPointList.size() << " dangerPt!";
+        if(bot.dangerPointList.size()<=bot.params.noMineDangers){
+            bot.noMinePlayer = true;
         }
     }
-    /*if(destroyFirst == true && game.turn == 5){
+    /*if(bot.destroyFirst == true && game.turn == 5){
         // if there is 2 suspect
         
         vector<Point> toDestroy;
         // furthest danger
         int minX = -1;
         Point thePt = Point{-1,-1};
-        for(int j = 0; j < dangerPointList.size(); j++){
+        for(int j = 0; j < bot.dangerPointList.size(); j++){
             if(minX == -1){
-                thePt = dangerPointList.at(j);
+                thePt = bot.dangerPointList.at(j);
             }
-            if(dangerPointList.at(j).x > thePt.x){
-                thePt = dangerPointList.at(j);
+            if(bot.dangerPointList.at(j).x > thePt.x){
+                thePt = bot.dangerPointList.at(j);
             }
-            //cerr << "DangerPT " << j << ":" << dangerPointList[j].x << "," << dangerPointList.at(j).y << "\n";
+            //cerr << "DangerPT " << j << ":" << bot.dangerPointList[j].x << "," << bot.dangerPointList.at(j).y << "\n";
         }
         if(thePt.x != -1){
             for(int i = 0; i < MAX_ROBOTS; i++){
-                if(me.robots.at(i).item == Type::NONE && actions.at(i).message == "READY"){
+                if(me.robots.at(i).item == Type::NONE && actions.at(i).message == Message::READY){
                     cerr << "Destroy:" << thePt.x << "," << thePt.y << "\n";
                     bool requestByOther = false;
                     for(int k = 0; k < MAX_ROBOTS; k++){
-                        if(actions.at(k).type == ActionType::DIG && actions.at(k).message == "DESTROY"){
+                        if(actions.at(k).type == ActionType::DIG && actions.at(k).message == Message::DESTROY){
                             if(k == i) continue;
                             requestByOther = true;
                             break;
                         }
                     }
                     if(!requestByOther){
-                        actions.at(i).dig(thePt, "DESTROY");
-                        destroyFirst = false;
+                        actions.at(i).dig(thePt, Message::DESTROY);
+                        bot.destroyFirst = false;
                         break;
                     }
                 }
             }
         }
     }
-    if(noMinePlayer == true){
+    if(bot.noMinePlayer == true){
         for(int i = 0; i < MAX_ROBOTS; i++){
-            if(me.robots.at(i).item == Type::NONE && actions.at(i).message == "READY"){
-                for(int j = 0; j < dangerPointList.size(); j++){
-                    //cerr << j << ":" << dangerPointList.at(j).x << "," << dangerPointList.at(j).y << "\n";
+            if(me.robots.at(i).item == Type::NONE && actions.at(i).message == Message::READY){
+                for(int j = 0; j < bot.dangerPointList.size(); j++){
+                    //cerr << j << ":" << bot.dangerPointList.at(j).x << "," << bot.dangerPointList.at(j).y << "\n";
                     // any enemyrobot around
                     bool theyAlso = false;
                     for(int k = 0; k < MAX_ROBOTS; k++){
-                        if(enemy.robots.at(k).distance(dangerPointList.at(j)) <= 1){
+                        if(enemy.robots.at(k).distance(bot.dangerPointList.at(j)) <= 1){
                             theyAlso = true;
                             break;
                         }
                     }
-                    if(me.robots.at(i).distance(dangerPointList.at(j)) <= 1 && theyAlso){
-                        actions.at(i).dig(dangerPointList.at(j), "DESTROY");
+                    if(me.robots.at(i).distance(bot.dangerPointList.at(j)) <= 1 && theyAlso){
+                        actions.at(i).dig(bot.dangerPointList.at(j), Message::DESTROY);
                     }
                 }
             }
@@ -1340,41 +2877,44 @@ array<Action, MAX_ROBOTS> getActions(Game& game) {
     }
     */
     //*********************************  Radar End  *****************************************************************
+    PROFILE_PHASE(Phase::ROBOT_DECISION);
+    // empty handed robots matched to ore cells together, the loop hands the cells out
+    array<Point, MAX_ROBOTS> digPlan = PlanDigPoints(bot, game, me, enemy, actions);
     for(int i = 0; i < MAX_ROBOTS; i++){
         // for robot dead
         if(me.robots.at(i).x == -1){
-            actions.at(i).wait("Dead");
+            actions.at(i).wait(Message::DEAD);
         }
 //*********************************  Rbbot In Base  *****************************************************************
         else if(me.robots.at(i).x == 0){
             //*********************************  Radar Carrier Start  *****************************************************************
             // if robot carry radar move to best radar point
-            if(me.robots.at(i).item == Type::RADAR && actions.at(i).message == "READY"){
-                NewRadarPoint(game, me, actions, i, radarPointList);
+            if(me.robots.at(i).item == Type::RADAR && actions.at(i).message == Message::READY){
+                NewRadarPoint(bot, game, me, actions, i, radarPointList);
             }
             //*********************************  Radar Carrier End  *****************************************************************
-            else if(me.robots.at(i).item == Type::TRAP && actions.at(i).message == "READY"){
+            else if(me.robots.at(i).item == Type::TRAP && actions.at(i).message == Message::READY){
                 // if on mission wall 1
-                if(game.traps.size() < 10){
-                    NewTrapPoint(game, me, enemy, actions, i);
+                if((int)game.traps.size() < bot.params.maxTraps){
+                    NewTrapPoint(bot, game, me, enemy, actions, i);
                 }
                 else{
-                    Point newPoint = NewDigPoint(game, me, actions, i, highestScore);
-                    actions.at(i).dig(newPoint, "OTW TRAP");
+                    Point newPoint = NewDigPoint(bot, game, me, actions, i);
+                    actions.at(i).dig(newPoint, Message::OTW_TRAP);
                 }
                 
             }
-            else if(me.robots.at(i).item == Type::HOLE && actions.at(i).message == "READY"){
+            else if(me.robots.at(i).item == Type::HOLE && actions.at(i).message == Message::READY){
                 // if on mission wall 1
-                if(game.traps.size() < 10){
-                    NewTrapPoint(game, me, enemy, actions, i);
+                if((int)game.traps.size() < bot.params.maxTraps){
+                    NewTrapPoint(bot, game, me, enemy, actions, i);
                 }
                 else{
-                    Point newPoint = NewDigPoint(game, me, actions, i, highestScore);
-                    actions.at(i).dig(newPoint, "OTW HOLE");
+                    Point newPoint = NewDigPoint(bot, game, me, actions, i);
+                    actions.at(i).dig(newPoint, Message::OTW_HOLE);
                 }
             }
-            else if(me.robots.at(i).item == Type::NONE && actions.at(i).message == "READY"){
+            else if(me.robots.at(i).item == Type::NONE && actions.at(i).message == Message::READY){
                 //*********************************  TRAP Assigned End *****************************************************************
                 bool requestByOther = false;
                 for(int j = 0; j < MAX_ROBOTS; j++){
@@ -1397,11 +2937,11 @@ array<Action, MAX_ROBOTS> getActions(Game& game) {
                 }
                 
                 // if got any tile worth putting
-                if(me.cooldownTrap == 0 && !requestByOther && countMe <= countYou && countMe > 2){
+                if(me.cooldownTrap == 0 && !requestByOther && countMe <= countYou && countMe > bot.params.trapMinRobots){
                     // check on robot at base
                     cerr << countMe << " vs " << countYou << "\n";
-                    if(game.traps.size() < 10)
-                        actions.at(i).request(Type::TRAP, "Gimme Trap");
+                    if((int)game.traps.size() < bot.params.maxTraps)
+                        actions.at(i).request(Type::TRAP, Message::GIMME_TRAP);
 
                 }
                 //*********************************  TRAP Assigned End *****************************************************************
@@ -1409,7 +2949,7 @@ array<Action, MAX_ROBOTS> getActions(Game& game) {
                 //*********************************  FAKE Assigned Start *****************************************************************
                 bool fakeByOther = false;
                 for(int j = 0; j < MAX_ROBOTS; j++){
-                    if(actions.at(j).type == ActionType::WAIT && actions.at(j).message == "Gimme HOLE"){
+                    if(actions.at(j).type == ActionType::WAIT && actions.at(j).message == Message::GIMME_HOLE){
                         if(j == i) continue;
                         fakeByOther = true;
                         break;
@@ -1417,60 +2957,63 @@ array<Action, MAX_ROBOTS> getActions(Game& game) {
                 }
                 
                 // if got any tile worth putting
-                if(game.fakeCD == 0 && !fakeByOther && countMe <= countYou && countMe > 2){
+                if(game.fakeCD == 0 && !fakeByOther && countMe <= countYou && countMe > bot.params.trapMinRobots){
                     // check on robot at base
-                    if(game.traps.size() < 10)
-                        actions.at(i).wait("Gimme HOLE");
+                    if((int)game.traps.size() < bot.params.maxTraps)
+                        actions.at(i).wait(Message::GIMME_HOLE);
                     
                 }
                 //*********************************  FAKE Assigned End *****************************************************************
                 
                 
                 // default action if still no action
-                if(actions.at(i).message == "READY"){
-                    Point newPoint = NewDigPoint(game, me, actions, i, highestScore);
-                    actions.at(i).dig(newPoint, "OTW");
+                if(actions.at(i).message == Message::READY){
+                    Point newPoint = PlannedDigPoint(bot, game, me, actions, i, digPlan);
+                    actions.at(i).dig(newPoint, Message::OTW);
                 }
             }
         }
 //*********************************  Rbbot Not In Base  *****************************************************************    
         else{
-            if(me.robots.at(i).item == Type::RADAR && actions.at(i).message == "READY"){
+            if(me.robots.at(i).item == Type::RADAR && actions.at(i).message == Message::READY){
                 //if reach destination
-                NewRadarPoint(game, me, actions, i, radarPointList);
+                NewRadarPoint(bot, game, me, actions, i, radarPointList);
             }
-            else if(me.robots.at(i).item == Type::TRAP && actions.at(i).message == "READY"){
+            else if(me.robots.at(i).item == Type::TRAP && actions.at(i).message == Message::READY){
                 // if on mission wall 1
-                if(game.traps.size() <= 10){
-                    NewTrapPoint(game, me, enemy, actions, i);
+                if((int)game.traps.size() < bot.params.maxTraps){
+                    NewTrapPoint(bot, game, me, enemy, actions, i);
                 }
                 else{
-                    Point newPoint = NewDigPoint(game, me, actions, i, highestScore);
-                    actions.at(i).dig(newPoint, "OTW TRAP");
+                    Point newPoint = NewDigPoint(bot, game, me, actions, i);
+                    actions.at(i).dig(newPoint, Message::OTW_TRAP);
                 }
             }
-            else if(me.robots.at(i).item == Type::HOLE && actions.at(i).message == "READY"){
+            else if(me.robots.at(i).item == Type::HOLE && actions.at(i).message == Message::READY){
                 // if on mission wall 1
-                if(game.traps.size() <= 10){
-                    NewTrapPoint(game, me, enemy, actions, i);
+                if((int)game.traps.size() < bot.params.maxTraps){
+                    NewTrapPoint(bot, game, me, enemy, actions, i);
                 }
                 else{
-                    Point newPoint = NewDigPoint(game, me, actions, i, highestScore);
-                    actions.at(i).dig(newPoint, "OTW HOLE");
+                    Point newPoint = NewDigPoint(bot, game, me, actions, i);
+                    actions.at(i).dig(newPoint, Message::OTW_HOLE);
                 }
             }
-            else if(me.robots.at(i).item == Type::NONE && actions.at(i).message == "READY"){
+            else if(me.robots.at(i).item == Type::NONE && actions.at(i).message == Message::READY){
                 //if reach destination
-                Point newPoint = NewDigPoint(game, me, actions, i, highestScore);
-                actions.at(i).dig(newPoint, "OTW");
+                Point newPoint = PlannedDigPoint(bot, game, me, actions, i, digPlan);
+                actions.at(i).dig(newPoint, Message::OTW);
             }
             // override if carry ore
-            else if(me.robots.at(i).item == Type::ORE && actions.at(i).message == "READY"){
-                vector<Point> candidateList;
-                int minDist = -1;
+            else if(me.robots.at(i).item == Type::ORE && actions.at(i).message == Message::READY){
+                Arena::Scope scope{game.arena};
+                Scratch<Point> candidateList{game.arena};
+                candidateList.reserve(MAX_HEIGHT);
+                pair<int, int> minDist{-1, -1};  // turns, then steps
                 Point homePoint = Point{-1,-1};
+                const DistanceField& field = TurnDistances(bot, game, me, enemy, actions, true).robot(i);
                 for(int y=0;y<MAX_HEIGHT;y++){
-                    bool isSafe = IsSafety(game.traps, me, game.players.at(1), actions, Point{0, y});
+                    bool isSafe = IsSafety(bot, game, me, game.players.at(1), actions, Point{0, y});
                     if(isSafe)
                     {
                         candidateList.push_back(Point{0,y});
@@ -1479,38 +3022,36 @@ array<Action, MAX_ROBOTS> getActions(Game& game) {
                 for(int z=0; z<candidateList.size(); z++)
                 {
                     //cerr << "homelist: " << candidateList.at(z).x << "," << candidateList.at(z).y << "\n";
-                    if(minDist == -1) {
+                    pair<int, int> dist{field.standTurns(candidateList.at(z)), candidateList.at(z).distance(me.robots.at(i))};
+                    if(minDist.first == -1 || dist < minDist){
                         homePoint = candidateList.at(z);
-                        minDist = candidateList.at(z).distance(me.robots.at(i));
-                    }
-                    if(candidateList.at(z).distance(me.robots.at(i)) < minDist){
-                        homePoint = candidateList.at(z);
-                        minDist = candidateList.at(z).distance(me.robots.at(i));
+                        minDist = dist;
                     }
                 }
-                if(homePoint.distance(me.robots.at(i)) >4)
+                // same test as MoveBack, more than a turn away goes through SetMovePoint
+                if(field.standTurns(homePoint) > 1)
                 {
-                    Point thisPt = SetMovePoint(game, me, actions, homePoint, i);
+                    Point thisPt = SetMovePoint(bot, game, me, actions, homePoint, i);
                     if(thisPt.x != -1){
-                        actions.at(i).move(thisPt, "GO HOME");
+                        actions.at(i).move(thisPt, Message::GO_HOME);
                     }
                     else{
-                        bool isSafe = IsSafety(game.traps, me, game.players.at(1), actions, me.robots.at(i));
+                        bool isSafe = IsSafety(bot, game, me, game.players.at(1), actions, me.robots.at(i));
                         if(isSafe)
-                            actions.at(i).wait("Wait HOME");
+                            actions.at(i).wait(Message::WAIT_HOME);
                         else
                         {
                             for(int x=me.robots.at(i).x-4; x <= me.robots.at(i).x+4; x++){
                                 if(x < 0) continue;
-                                bool newSafe = IsSafety(game.traps, me, game.players.at(1), actions, Point{x, me.robots.at(i).y});
+                                bool newSafe = IsSafety(bot, game, me, game.players.at(1), actions, Point{x, me.robots.at(i).y});
                                 if(newSafe)
-                                    actions.at(i).move(Point{x, me.robots.at(i).y}, "Evade!");
+                                    actions.at(i).move(Point{x, me.robots.at(i).y}, Message::EVADE);
                                 else{
                                     for(int y=me.robots.at(i).y-4; y < me.robots.at(i).y+4; y++){
                                         if(y < 0||y >= MAX_HEIGHT-1) continue; 
-                                        newSafe = IsSafety(game.traps, me, game.players.at(1), actions, Point{me.robots.at(i).x, y});
+                                        newSafe = IsSafety(bot, game, me, game.players.at(1), actions, Point{me.robots.at(i).x, y});
                                         if(newSafe)
-                                            actions.at(i).move(Point{me.robots.at(i).x, y}, "Evade!");
+                                            actions.at(i).move(Point{me.robots.at(i).x, y}, Message::EVADE);
                                     }
                                 }
                             }
@@ -1520,13 +3061,14 @@ array<Action, MAX_ROBOTS> getActions(Game& game) {
                 }
                 else
                 {
-                    actions.at(i).move(homePoint, "GO HOME");
+                    actions.at(i).move(homePoint, Message::GO_HOME);
                 }
             }
         }
     }
     
     // kamikaze
+    PROFILE_PHASE(Phase::KAMIKAZE);
     for(int j = 0; j < MAX_ROBOTS; j++){
         // beside a bomb?
         for(int i = 0; i< game.traps.size(); i++){
@@ -1535,13 +3077,13 @@ array<Action, MAX_ROBOTS> getActions(Game& game) {
                 if(me.ore < enemy.ore){
                     bool kamikaze = CheckExplosion(game, me, enemy, game.traps.at(i),2);
                     if(kamikaze){
-                        actions.at(j).dig(game.traps.at(i), "KAMIKAZE");
+                        actions.at(j).dig(game.traps.at(i), Message::KAMIKAZE);
                     }
                 }
                 else{
                     bool kamikaze = CheckExplosion(game, me, enemy, game.traps.at(i),1);
                     if(kamikaze){
-                        actions.at(j).dig(game.traps.at(i), "KAMIKAZE");
+                        actions.at(j).dig(game.traps.at(i), Message::KAMIKAZE);
                     }
                 }
             }
@@ -1554,7 +3096,7 @@ array<Action, MAX_ROBOTS> getActions(Game& game) {
     for(int k=0; k<MAX_ROBOTS; k++){
         // this enemy coming back & the Y of this robot have a trap
         bool trapFound = CheckTrap(game.traps, Point{1,enemy.robots.at(k).y});
-        if(enemy.robots.at(k).x < prevEnemyPos.at(k).x && trapFound && enemy.robots.at(k).distance(Point{1,enemy.robots.at(k).y}) <=5){
+        if(enemy.robots.at(k).x < bot.prevEnemyPos.at(k).x && trapFound && enemy.robots.at(k).distance(Point{1,enemy.robots.at(k).y}) <=5){
             count++;
             PotentialTrap.push_back(Point{1,enemy.robots.at(k).y});
         }
@@ -1589,7 +3131,7 @@ array<Action, MAX_ROBOTS> getActions(Game& game) {
             if(index != -1){
                 bool someoneGoing = false;
                 for(int i = 0; i < MAX_ROBOTS; i++){
-                    if(actions.at(i).message == "OTW KAMIKAZE"){
+                    if(actions.at(i).message == Message::OTW_KAMIKAZE){
                         someoneGoing = true;
                         break;
                     }
@@ -1599,7 +3141,7 @@ array<Action, MAX_ROBOTS> getActions(Game& game) {
                         if(me.robots.at(i).item != Type::RADAR){
                             for(int j = 0; j < linkTraps.size(); j++){
                                 if(me.robots.at(i).distance(linkTraps.at(j)) <=5){
-                                    actions.at(i).move(linkTraps.at(j), "OTW KAMIKAZE");
+                                    actions.at(i).move(linkTraps.at(j), Message::OTW_KAMIKAZE);
                                     goto KAMIKAZE;
                                 }
                             }
@@ -1615,21 +3157,21 @@ array<Action, MAX_ROBOTS> getActions(Game& game) {
     // rigged 1 two turn
     for(int j = 0; j < MAX_ROBOTS; j++){
         if(game.turn == 1){
-            if(actions.at(j).type != ActionType::REQUEST && actions.at(j).message != "Gimme HOLE"){
+            if(actions.at(j).type != ActionType::REQUEST && actions.at(j).message != Message::GIMME_HOLE){
                 // check worth explosion or not
-                actions.at(j).wait("Dreaming..");
+                actions.at(j).wait(Message::DREAMING);
             }
         }
         if(game.turn == 2){
             if(me.robots.at(j).x == 0 && me.robots.at(j).item == Type::NONE){
                 // check worth explosion or not
-                int chance = 1 + (rand() % 100);
+                int chance = 1 + (bot.nextRandom() % 100);
                 if(chance < 50);
-                    actions.at(j).dig(Point{1, me.robots.at(j).y}, "sync attack !");
+                    actions.at(j).dig(Point{1, me.robots.at(j).y}, Message::SYNC_ATTACK);
             }
             if(me.robots.at(j).x == 0 && me.robots.at(j).item == Type::TRAP){
                 // check worth explosion or not
-                actions.at(j).dig(Point{1, me.robots.at(j).y}, "sync attack !");
+                actions.at(j).dig(Point{1, me.robots.at(j).y}, Message::SYNC_ATTACK);
             }
         }
     }
@@ -1639,102 +3181,180 @@ array<Action, MAX_ROBOTS> getActions(Game& game) {
         if((me.robots.at(j).item == Type::RADAR||me.robots.at(j).item == Type::TRAP) && 
             actions.at(j).type == ActionType::DIG &&
             actions.at(j).dest.x == 0){
-            Point newPoint = NewDigPoint(game, me, actions, j, highestScore);
-            actions.at(j).dig(newPoint, "OTW Left4Dead");
+            Point newPoint = NewDigPoint(bot, game, me, actions, j);
+            actions.at(j).dig(newPoint, Message::OTW_LEFT4DEAD);
         }
-        
-        // update enemy position
-        prevEnemyPos.at(j) = Point({enemy.robots.at(j).x, enemy.robots.at(j).y});
-        prevOurPos.at(j) = Point({me.robots.at(j).x, me.robots.at(j).y});
     }
     
-    prevActions = actions;
+    actions = SearchPlan(bot, game, me, enemy, actions);
+
+    // update enemy position once every decision of this turn is made
+    for(int j = 0; j < MAX_ROBOTS; j++){
+        bot.prevEnemyPos.at(j) = Point({enemy.robots.at(j).x, enemy.robots.at(j).y});
+        bot.prevOurPos.at(j) = Point({me.robots.at(j).x, me.robots.at(j).y});
+    }
+    
+    bot.prevActions = actions;
     // end smart code
     return actions;
 }
 
-//*********************************  MAIN  *****************************************************************
+//*********************************  RECORDER  *****************************************************************
+// build with -DAI_RECORD to log every turn in binary to $AI_RECORD_FILE (default game.rec), Replay.cpp feed it back
+// header: "UTGR" version width height, then per turn:
+//   u16 myOre, u16 enemyOre, u8 per cell row by row (bit 7 hole, low bits ore+1, 0 for "?"),
+//   u8 radarCooldown, u8 trapCooldown, u8 entityCount, entities (u16 id, u8 type, i8 x, i8 y, i8 item),
+//   u32 rng state before thinking, 5 actions (u8 type, u8 item, i8 x, i8 y, u8 message)
+#ifdef AI_RECORD
+static constexpr uint8_t RECORD_VERSION = 2;
 
-int main() {
-    Game game;
+struct TurnRecorder {
+    ofstream out;
 
-    // weighted graph
-    for(int x=1; x < MAX_WIDTH; x++){
-        for(int y=0; y < MAX_HEIGHT; y++){
-            int score = 0;
-            
-            for(int _x = x-4; _x <= x+4; _x++){
-                for(int _y = y-4; _y <= y+4; _y++){
-                    if(_x < 1 || _x >= MAX_WIDTH) continue;
-                    if(_y < 0 || _y >= MAX_HEIGHT) continue;
-                    // for distance smaller than 5 valid point
-                    if(Point({x,y}).distance(Point({_x,_y})) < 5){
-                        // no hole score
-                        score += 4 - Point({x,y}).distance(Point({_x,_y}));
-                    }
-                }
-            }
-                        
-            game.grid.at(x).at(y).score = score;
-            //cerr << score << ",";
+    bool open(const string& path, int width, int height) {
+        out.open(path, ios::binary);
+        if (!out) return false;
+        out.write("UTGR", 4);
+        put(RECORD_VERSION);
+        put(width);
+        put(height);
+        return true;
+    }
+    void put(int v) { out.put((char)(uint8_t)v); }
+    void put16(int v) { put(v & 0xFF); put((v >> 8) & 0xFF); }
+    void write(const TurnInput& input, uint32_t rng, const array<Action, MAX_ROBOTS>& actions) {
+        if (!out) return;
+        put16(input.myOre);
+        put16(input.enemyOre);
+        for (int y = 0; y < MAX_HEIGHT; y++) {
+            for (int x = 0; x < MAX_WIDTH; x++) put((input.hole[y][x] ? 0x80 : 0) | (input.ore[y][x] + 1));
+        }
+        put(input.radarCooldown);
+        put(input.trapCooldown);
+        put(input.entities.size());
+        for (const TurnInput::EntityInput& e : input.entities) {
+            put16(e.id);
+            put(e.type);
+            put(e.x);
+            put(e.y);
+            put(e.item);
+        }
+        for (int k = 0; k < 4; k++) put((rng >> (8 * k)) & 0xFF);
+        for (const Action& action : actions) {
+            put((int)action.type);
+            put((int)action.item);
+            put(action.dest.x);
+            put(action.dest.y);
+            put((int)action.message);
         }
-        //cerr << "\n";
+        out.flush();
+    }
+};
+
+struct TurnReader {
+    ifstream in;
+    int width{0}, height{0};
+
+    bool open(const string& path) {
+        in.open(path, ios::binary);
+        char magic[4];
+        if (!in.read(magic, 4) || string(magic, 4) != "UTGR" || get() != RECORD_VERSION) return false;
+        width = get();
+        height = get();
+        return width == MAX_WIDTH && height == MAX_HEIGHT;
+    }
+    int get() { return (uint8_t)in.get(); }
+    int getSigned() { return (int8_t)in.get(); }
+    int get16() { int lo = get(); return lo | (get() << 8); }
+    // false at end of log
+    bool read(TurnInput& input, uint32_t& rng, array<Action, MAX_ROBOTS>& actions) {
+        input.myOre = get16();
+        input.enemyOre = get16();
+        if (!in) return false;
+        for (int y = 0; y < MAX_HEIGHT; y++) {
+            for (int x = 0; x < MAX_WIDTH; x++) {
+                int cell = get();
+                input.hole[y][x] = (cell & 0x80) != 0;
+                input.ore[y][x] = (cell & 0x7F) - 1;
+            }
+        }
+        input.radarCooldown = get();
+        input.trapCooldown = get();
+        input.entities.resize(get());
+        for (TurnInput::EntityInput& e : input.entities) {
+            e.id = get16();
+            e.type = get();
+            e.x = getSigned();
+            e.y = getSigned();
+            e.item = getSigned();
+        }
+        rng = 0;
+        for (int k = 0; k < 4; k++) rng |= (uint32_t)get() << (8 * k);
+        for (Action& action : actions) {
+            action.type = (ActionType)get();
+            action.item = (Type)get();
+            action.dest.x = getSigned();
+            action.dest.y = getSigned();
+            action.message = (Message)get();
+        }
+        return (bool)in;
     }
+};
+
+TurnRecorder recorder;
+#define RECORD_OPEN(width, height) recorder.open(getenv("AI_RECORD_FILE") ? getenv("AI_RECORD_FILE") : "game.rec", width, height)
+#define RECORD_TURN(input, rng, actions) recorder.write(input, rng, actions)
+#else
+#define RECORD_OPEN(width, height)
+#define RECORD_TURN(input, rng, actions)
+#endif
+
+//*********************************  MAIN  *****************************************************************
+
+#ifndef AI_NO_MAIN
+int main() {
+    BotContext bot;
+    // tuned constants from $AI_PARAMS, the compiled-in set otherwise
+    if (getenv("AI_PARAMS")) {
+        ifstream file(getenv("AI_PARAMS"));
+        bot.params.load(file);
+    }
+    // the plan search stays off until it wins a measured match (match -e, tournament -e),
+    // $AI_SEARCH_MS runs it on the clock with that many ms a turn, 0 for the default budget
+    bool search = getenv("AI_SEARCH_MS") != nullptr;
+    if (search && atof(getenv("AI_SEARCH_MS")) > 0) bot.searchBudget.turnMs = atof(getenv("AI_SEARCH_MS"));
+    Game game;
+    game.initScore(bot.params);
     
     // global inputs
+    TurnParser parser;
     int width;
     int height;  // size of the map
-    cin >> width >> height;
-    cin.ignore();
+    parser.header(width, height);
+
+    RECORD_OPEN(width, height);
 
     // game loop
-    while (1) {
-        
+    TurnInput input;
+    while (parser.parse(input, width, height)) {
+        auto turnStart = chrono::steady_clock::now();
         game.reset();
-        // first loop local inputs
-        int myOre;
-        int enemyOre;
-        cin >> myOre >> enemyOre;
-        cin.ignore();
-        game.updateOre(0, myOre);
-        game.updateOre(1, enemyOre);
-
-        // other loop local inputs
-        for (int i = 0; i < height; i++) {
-            for (int j = 0; j < width; j++) {
-                string ore;  // amount of ore or "?" if unknown
-                int hole;           // 1 if cell has a hole
-                cin >> ore >> hole;
-                cin.ignore();
-                game.updateCell(j, i, ore, hole);
-            }
-        }
-        int entityCount;    // number of visible entities
-        int radarCooldown;  // turns left until a new radar can be requested
-        int trapCooldown;   // turns left until a new trap can be requested
-        cin >> entityCount >> radarCooldown >> trapCooldown;
-        cin.ignore();
-        game.updateCooldown(0, radarCooldown, trapCooldown);
-        for (int i = 0; i < entityCount; i++) {
-            int id;    // unique id of the entity
-            int type;  // 0 for your robot, 1 for other robot, 2 for radar, 3 for trap
-            int x;
-            int y;     // position of the entity
-            int item;  // if this entity is a robot, the item it is carrying (-1 for NONE, 2 for RADAR, 3 for TRAP, 4 for ORE)
-            cin >> id >> type >> x >> y >> item;
-            cin.ignore();
-            game.updateEntity(id, type, x, y, item);
-        }
+        input.apply(game);
+        if (search) bot.searchBudget.start(turnStart, game.turn);
+        [[maybe_unused]] uint32_t rng = bot.rngState;
 
         // AI ------------------------------------------------------------------
-        auto actions{getActions(game)};
+        auto actions{getActions(bot, game)};
         // AI ------------------------------------------------------------------
 
-        for (const Action& action : actions) {
-            // Write an action using cout. DON'T FORGET THE "<< endl"
-            // To debug: cerr << "Debug messages..." << endl;
-
-            cout << action << "\n";  // WAIT|MOVE x y|REQUEST item
-        }
-    }
+        // WAIT|MOVE x y|DIG x y|REQUEST item, one line per robot
+        // To debug: cerr << "Debug messages..." << endl;
+        WriteActions(actions);
+        RECORD_TURN(input, rng, actions);
+        // the server may stop the process after the last turn instead of closing stdin
+        if (game.turn == MAX_TURNS) { PROFILE_DUMP(); }
+    }
+    // stdin closed before the last turn
+    if (game.turn < MAX_TURNS) { PROFILE_DUMP(); }
 }
+#endif
@@ -0,0 +1,503 @@
+// Microbenchmarks: the input parser on turns captured from headless referee games, the decision
+// kernels on synthetic boards swept over trap, danger point, visible ore and radar counts, the GameState
+// forward model against the referee, the heap calls of getActions.
+//     g++ -std=c++17 -O2 Bench.cpp -o bench
+//     ./bench [parse|kernels|forward|alloc|all=all] [reps=20] [seed=1] [alloc budget=0]
+// each sweep prints ns/op per kernel and the log-log slope over its upper half, above 1 is superlinear;
+// alloc needs -DAI_ALLOC, plays reps games and exits 1 when a turn past the warm-up allocates over budget
+#define AI_NO_MAIN
+#include "AI.cpp"
+#include "Referee.h"
+
+#include <cmath>
+#include <cstdio>
+#include <iomanip>
+#include <sstream>
+
+//*********************************  INPUTS  **********************************************
+
+// the referee view of player 0 for every turn of as many games as it takes
+vector<TurnInput> CaptureTurns(int count, uint32_t seed) {
+    vector<TurnInput> turns;
+    streambuf* debug = cerr.rdbuf(nullptr);
+    for (uint32_t g = seed; (int)turns.size() < count; g++) {
+        Referee referee{g};
+        referee.onTurn = [&](int owner, const TurnInput& input, uint32_t, const array<Action, MAX_ROBOTS>&) {
+            if (owner == 0 && (int)turns.size() < count) turns.push_back(input);
+        };
+        referee.play({getActions, getActions});
+    }
+    cerr.rdbuf(debug);
+    return turns;
+}
+
+// the exact lines the CodinGame referee sends
+string FormatTurns(const vector<TurnInput>& turns) {
+    ostringstream out;
+    out << MAX_WIDTH << " " << MAX_HEIGHT << "\n";
+    for (const TurnInput& input : turns) {
+        out << input.myOre << " " << input.enemyOre << "\n";
+        for (int y = 0; y < MAX_HEIGHT; y++) {
+            for (int x = 0; x < MAX_WIDTH; x++) {
+                if (input.ore[y][x] == -1) out << "?";
+                else out << (int)input.ore[y][x];
+                out << " " << (int)input.hole[y][x] << (x + 1 == MAX_WIDTH ? "\n" : " ");
+            }
+        }
+        out << input.entities.size() << " " << input.radarCooldown << " " << input.trapCooldown << "\n";
+        for (const TurnInput::EntityInput& e : input.entities) {
+            out << e.id << " " << e.type << " " << e.x << " " << e.y << " " << e.item << "\n";
+        }
+    }
+    return out.str();
+}
+
+bool SameInput(const TurnInput& a, const TurnInput& b) {
+    if (a.myOre != b.myOre || a.enemyOre != b.enemyOre || a.ore != b.ore || a.hole != b.hole) return false;
+    if (a.radarCooldown != b.radarCooldown || a.trapCooldown != b.trapCooldown) return false;
+    if (a.entities.size() != b.entities.size()) return false;
+    for (size_t i = 0; i < a.entities.size(); i++) {
+        const TurnInput::EntityInput& e = a.entities.at(i);
+        const TurnInput::EntityInput& f = b.entities.at(i);
+        if (e.id != f.id || e.type != f.type || e.x != f.x || e.y != f.y || e.item != f.item) return false;
+    }
+    return true;
+}
+
+// how main() read a turn before TurnParser
+void StreamParse(istream& in, TurnInput& input, int width, int height) {
+    in >> input.myOre >> input.enemyOre;
+    in.ignore();
+    for (int i = 0; i < height; i++) {
+        for (int j = 0; j < width; j++) {
+            string ore;
+            int hole;
+            in >> ore >> hole;
+            in.ignore();
+            input.ore[i][j] = ore == "?" ? -1 : stoi(ore);
+            input.hole[i][j] = hole;
+        }
+    }
+    int entityCount;
+    in >> entityCount >> input.radarCooldown >> input.trapCooldown;
+    in.ignore();
+    input.entities.resize(entityCount);
+    for (TurnInput::EntityInput& e : input.entities) {
+        in >> e.id >> e.type >> e.x >> e.y >> e.item;
+        in.ignore();
+    }
+}
+
+//*********************************  BENCHMARKS  **********************************************
+
+double Elapsed(chrono::steady_clock::time_point start) {
+    return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+}
+
+void BenchParse(const vector<TurnInput>& turns) {
+    string text = FormatTurns(turns);
+    int count = (int)turns.size();
+    int mismatches = 0;
+
+    istringstream stream(text);
+    int width, height;
+    TurnInput input;
+    auto start = chrono::steady_clock::now();
+    stream >> width >> height;
+    stream.ignore();
+    for (int t = 0; t < count; t++) StreamParse(stream, input, width, height);
+    double streamNs = Elapsed(start);
+
+    // a file descriptor like the real stdin, one read() per buffer
+    FILE* file = tmpfile();
+    fwrite(text.data(), 1, text.size(), file);
+    fflush(file);
+    lseek(fileno(file), 0, SEEK_SET);
+    TurnParser parser;
+    parser.fd = fileno(file);
+    parser.header(width, height);
+    double parserNs = 0;
+    for (int t = 0; t < count; t++) {
+        auto turnStart = chrono::steady_clock::now();
+        parser.parse(input, width, height);
+        parserNs += Elapsed(turnStart);
+        mismatches += !SameInput(input, turns.at(t));
+    }
+    fclose(file);
+
+    cout << "parse      istream " << streamNs / count << " ns/turn, TurnParser " << parserNs / count
+         << " ns/turn (" << streamNs / parserNs << "x)" << (mismatches ? ", MISMATCH on " + to_string(mismatches) + " turns" : "")
+         << "\n";
+}
+
+//----------------------------------Synthetic boards----------------------------------------------------------
+struct BoardSpec {
+    int traps{20};
+    int dangers{10};
+    double oreDensity{0.3};  // share of radar covered cells with ore
+    int radars{6};
+};
+
+// a late game view of player 0 with the bot memory it would carry
+struct Board {
+    Game game;
+    BotContext bot;
+};
+
+Board MakeBoard(const BoardSpec& spec, uint32_t seed) {
+    mt19937 rng{seed};
+    auto random = [&rng](int lo, int hi) { return uniform_int_distribution<int>(lo, hi)(rng); };
+    TurnInput input;
+    input.myOre = random(0, 40);
+    input.enemyOre = random(0, 40);
+    int id = 0;
+    for (int owner = 0; owner < MAX_PLAYERS; owner++) {
+        for (int i = 0; i < MAX_ROBOTS; i++) {
+            int item = owner == 0 ? array<int, 4>{-1, 2, 3, 4}.at(random(0, 3)) : -1;
+            input.entities.push_back({id++, owner, random(0, MAX_WIDTH - 1), random(0, MAX_HEIGHT - 1), item});
+        }
+    }
+    Bitboard holes, covered;
+    for (int i = 0; i < spec.radars; i++) {
+        Point p{random(1, MAX_WIDTH - 1), random(0, MAX_HEIGHT - 1)};
+        input.entities.push_back({id++, 2, p.x, p.y, -1});
+        holes.set(p);
+        Bitboard at;
+        at.set(p);
+        covered = covered | at.dilate(RADAR_RANGE);
+    }
+    // traps crowd the first columns like they do late in a game, the rest anywhere
+    for (int i = 0; i < spec.traps; i++) {
+        Point p{i % 2 == 0 ? random(1, 4) : random(1, MAX_WIDTH - 1), random(0, MAX_HEIGHT - 1)};
+        input.entities.push_back({id++, 3, p.x, p.y, -1});
+        holes.set(p);
+    }
+    for (int y = 0; y < MAX_HEIGHT; y++) {
+        for (int x = 0; x < MAX_WIDTH; x++) {
+            input.hole[y][x] = holes.test(x, y) || (x > 0 && random(0, 99) < 15);
+            input.ore[y][x] = -1;
+            if (covered.test(x, y)) input.ore[y][x] = uniform_real_distribution<double>(0, 1)(rng) < spec.oreDensity ? random(1, 3) : 0;
+        }
+    }
+
+    Board board;
+    board.game.initScore(board.bot.params);
+    board.game.turn = 149;
+    board.game.reset();
+    input.apply(board.game);
+    board.game.trapChains.sync(board.game.trapMask);
+
+    BotContext& bot = board.bot;
+    for (int i = 0; i < MAX_ROBOTS; i++) {
+        // half of the enemy heading back to base
+        Robot& enemy = board.game.players.at(1).robots.at(i);
+        bot.prevEnemyPos.at(i) = Point{min(MAX_WIDTH - 1, enemy.x + (i % 2)), enemy.y};
+        bot.prevOurPos.at(i) = board.game.players.at(0).robots.at(i);
+        bot.trapBelief.carry.at(i) = i == 0;
+    }
+    for (int i = 0; i < spec.dangers; i++) {
+        Point p{random(1, 12), random(0, MAX_HEIGHT - 1)};
+        if (!board.game.trapMask.test(p)) bot.trapBelief.raise(bot, p, 1, board.game.turn - random(0, 50), Reason::NEW_HOLE);
+    }
+    ClassifyEvents(bot, board.game);
+    bot.oreBelief.update(board.game, board.game.players.at(0));
+    return board;
+}
+
+//----------------------------------Kernels----------------------------------------------------------
+// each kernel runs reps times against one board and its bot, returns ns per call
+using Kernel = function<double(Board&, int reps)>;
+
+double TimeCalls(int calls, const function<void(int)>& call) {
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < calls; i++) call(i);
+    return Elapsed(start) / max(calls, 1);
+}
+
+const vector<pair<string, Kernel>> KERNELS{
+    {"IsSafety", [](Board& board, int reps) {
+         Game& game = board.game;
+         array<Action, MAX_ROBOTS> actions;
+         IsSafety(board.bot, game, game.players.at(0), game.players.at(1), actions, Point{1, 1});
+         return TimeCalls(reps * MAX_WIDTH * MAX_HEIGHT, [&](int i) {
+             Point p{i % MAX_WIDTH, i / MAX_WIDTH % MAX_HEIGHT};
+             IsSafety(board.bot, game, game.players.at(0), game.players.at(1), actions, p);
+         });
+     }},
+    {"SafetyBuild", [](Board& board, int reps) {
+         Game& game = board.game;
+         array<Action, MAX_ROBOTS> actions;
+         return TimeCalls(reps, [&](int) {
+             board.bot.safetyMap.turn = -1;
+             IsSafety(board.bot, game, game.players.at(0), game.players.at(1), actions, Point{1, 1});
+         });
+     }},
+    // base and every robot field against the unsafe cells
+    {"DistanceFields", [](Board& board, int reps) {
+         Game& game = board.game;
+         array<Action, MAX_ROBOTS> actions;
+         return TimeCalls(reps, [&](int) {
+             board.bot.distanceFields.at(1).turn = -1;
+             DistanceFields& fields = TurnDistances(board.bot, game, game.players.at(0), game.players.at(1), actions, true);
+             fields.base();
+             for (int i = 0; i < MAX_ROBOTS; i++) fields.robot(i);
+         });
+     }},
+    // from the prior, every visible cell is new evidence
+    {"OreBelief", [](Board& board, int reps) {
+         Game& game = board.game;
+         return TimeCalls(reps, [&](int) {
+             board.bot.oreBelief.ready = false;
+             board.bot.oreBelief.update(game, game.players.at(0));
+         });
+     }},
+    // one turn of enemy events, the danger list follows
+    {"TrapBelief", [](Board& board, int reps) {
+         Game& game = board.game;
+         return TimeCalls(reps, [&](int) { board.bot.trapBelief.update(board.bot, game); });
+     }},
+    {"NewDigPoint", [](Board& board, int reps) {
+         Game& game = board.game;
+         array<Action, MAX_ROBOTS> actions;
+         return TimeCalls(reps * MAX_ROBOTS, [&](int i) { NewDigPoint(board.bot, game, game.players.at(0), actions, i % MAX_ROBOTS); });
+     }},
+    {"SetMovePoint", [](Board& board, int reps) {
+         Game& game = board.game;
+         array<Action, MAX_ROBOTS> actions;
+         return TimeCalls(reps * MAX_ROBOTS, [&](int i) {
+             Point dest{(i * 7) % (MAX_WIDTH - 1) + 1, (i * 5) % MAX_HEIGHT};
+             SetMovePoint(board.bot, game, game.players.at(0), actions, dest, i % MAX_ROBOTS);
+         });
+     }},
+    {"RadarScore", [](Board& board, int reps) {
+         Game& game = board.game;
+         volatile int sink = 0;
+         return TimeCalls(reps * MAX_WIDTH * MAX_HEIGHT, [&](int i) {
+             sink = sink + AdditionalRadarScore(game, Point{i % (MAX_WIDTH - 1) + 1, i / MAX_WIDTH % MAX_HEIGHT});
+         });
+     }},
+    {"CheckExplosion", [](Board& board, int reps) {
+         Game& game = board.game;
+         if (game.traps.empty()) return 0.0;
+         return TimeCalls(reps * MAX_ROBOTS, [&](int i) {
+             CheckExplosion(game, game.players.at(0), game.players.at(1), game.traps.at(i % game.traps.size()), 1);
+         });
+     }},
+    // LinkedTraps only lives on in commented out code, the chain index replaced it
+    {"TrapChains", [](Board& board, int reps) {
+         ChainIndex& chains = board.game.trapChains;
+         volatile int sink = 0;
+         return TimeCalls(reps, [&](int) {
+             chains.rebuild(board.game.trapMask);
+             chains.members.forEach([&](Point p) {
+                 int r = Bitboard::index(p.x, p.y);
+                 if (chains.find(r) == r) sink = sink + chains.blast(r).count();
+             });
+         });
+     }},
+    {"NewTrapPoint", [](Board& board, int reps) {
+         Game& game = board.game;
+         array<Action, MAX_ROBOTS> actions;
+         return TimeCalls(reps * MAX_ROBOTS, [&](int i) {
+             actions.at(i % MAX_ROBOTS).wait();
+             NewTrapPoint(board.bot, game, game.players.at(0), game.players.at(1), actions, i % MAX_ROBOTS);
+         });
+     }},
+    // getActions moves the board on, every call gets a fresh copy
+    {"getActions", [](Board& board, int reps) {
+         double total = 0;
+         for (int i = 0; i < reps; i++) {
+             Board copy = board;
+             auto start = chrono::steady_clock::now();
+             getActions(copy.bot, copy.game);
+             total += Elapsed(start);
+         }
+         return total / max(reps, 1);
+     }},
+};
+
+// ns/op of every kernel, averaged over boards from several seeds
+vector<double> RunKernels(const BoardSpec& spec, int reps, uint32_t seed) {
+    static constexpr int BOARDS = 8;
+    vector<double> ns(KERNELS.size(), 0);
+    for (int b = 0; b < BOARDS; b++) {
+        Board board = MakeBoard(spec, seed + b);
+        for (size_t k = 0; k < KERNELS.size(); k++) {
+            Board scratch = board;
+            ns.at(k) += KERNELS.at(k).second(scratch, reps) / BOARDS;
+        }
+    }
+    return ns;
+}
+
+void Sweep(const string& name, const vector<double>& values, const function<void(BoardSpec&, double)>& set, int reps, uint32_t seed) {
+    cout << "\n" << setw(10) << name;
+    for (const auto& kernel : KERNELS) cout << setw(15) << kernel.first;
+    cout << "\n";
+    vector<vector<double>> rows;
+    for (double value : values) {
+        BoardSpec spec;
+        set(spec, value);
+        rows.push_back(RunKernels(spec, reps, seed));
+        cout << setw(10) << value;
+        for (double ns : rows.back()) cout << setw(15) << fixed << setprecision(0) << ns;
+        cout << defaultfloat << setprecision(6) << "\n";
+    }
+    // growth exponent between the middle and the last point
+    size_t mid = values.size() / 2, last = values.size() - 1;
+    cout << setw(10) << "slope";
+    for (size_t k = 0; k < KERNELS.size(); k++) {
+        double a = rows.at(mid).at(k), b = rows.at(last).at(k);
+        bool valid = values.at(mid) > 0 && a > 0 && b > 0;
+        cout << setw(15) << fixed << setprecision(2);
+        if (valid) cout << log(b / a) / log(values.at(last) / values.at(mid));
+        else cout << "-";
+    }
+    cout << defaultfloat << setprecision(6) << "\n";
+}
+
+//----------------------------------Forward model----------------------------------------------------------
+// the referee with everything in sight, as GameState sees it
+GameState TrueState(Referee& referee) {
+    GameState s;
+    for (int y = 0; y < MAX_HEIGHT; y++) {
+        for (int x = 0; x < MAX_WIDTH; x++) {
+            Cell cell = referee.get(Point{x, y});
+            s.ore[Bitboard::index(x, y)] = (int8_t)cell.ore;
+            s.holes.set(x, y, cell.hole);
+        }
+    }
+    for (Entity& trap : referee.traps) s.traps.set(trap);
+    for (Entity& radar : referee.radars) s.radars.at(radar.owner).set(radar);
+    for (int owner = 0; owner < MAX_PLAYERS; owner++) {
+        Player& player = referee.players.at(owner);
+        for (int i = 0; i < MAX_ROBOTS; i++) {
+            Robot& robot = player.robots.at(i);
+            s.bots.at(owner).at(i) = GameState::Bot{(int8_t)robot.x, (int8_t)robot.y, robot.item};
+        }
+        s.score.at(owner) = (int16_t)player.ore;
+        s.cooldownRadar.at(owner) = (int8_t)player.cooldownRadar;
+        s.cooldownTrap.at(owner) = (int8_t)player.cooldownTrap;
+    }
+    s.turn = (int16_t)referee.turn;
+    return s;
+}
+
+bool SameState(const GameState& a, const GameState& b) {
+    auto sameBoards = [](const Bitboard& p, const Bitboard& q) { return p.andNot(q).count() == 0 && q.andNot(p).count() == 0; };
+    if (a.ore != b.ore || !sameBoards(a.holes, b.holes) || !sameBoards(a.traps, b.traps)) return false;
+    for (int owner = 0; owner < MAX_PLAYERS; owner++) {
+        if (!sameBoards(a.radars.at(owner), b.radars.at(owner))) return false;
+        for (int i = 0; i < MAX_ROBOTS; i++) {
+            const GameState::Bot& p = a.bots.at(owner).at(i);
+            const GameState::Bot& q = b.bots.at(owner).at(i);
+            if (p.x != q.x || p.y != q.y || p.item != q.item) return false;
+        }
+    }
+    return a.score == b.score && a.cooldownRadar == b.cooldownRadar && a.cooldownTrap == b.cooldownTrap && a.turn == b.turn;
+}
+
+// GameState::apply checked against Referee::step on every turn of real games, then timed on the same turns
+void BenchForward(int games, uint32_t seed) {
+    int steps = 0, mismatches = 0;
+    for (int x = 0; x < MAX_WIDTH; x++) {
+        for (int y = 0; y < MAX_HEIGHT; y++) {
+            for (int range = 1; range <= MOVE_RANGE; range++) {
+                Bitboard::full().forEach([&](Point dest) {
+                    Point a = GameState::stepToward(Point{x, y}, dest, range), b = Referee::stepToward(Point{x, y}, dest, range);
+                    mismatches += a.x != b.x || a.y != b.y;
+                });
+            }
+        }
+    }
+    cout << "stepToward mismatches against the referee: " << mismatches << "\n";
+
+    vector<pair<GameState, GameState::Orders>> turns;
+    mismatches = 0;
+    streambuf* debug = cerr.rdbuf(nullptr);
+    for (int g = 0; g < games; g++) {
+        Referee referee{seed + g};
+        GameState::Orders orders;
+        GameState before, expected;
+        bool pending = false;
+        referee.onTurn = [&](int owner, const TurnInput&, uint32_t, const array<Action, MAX_ROBOTS>& actions) {
+            if (owner == 0 && pending) {
+                // the referee has stepped since the last seat played
+                expected = before;
+                expected.apply(orders);
+                mismatches += !SameState(expected, TrueState(referee));
+                steps++;
+                turns.emplace_back(before, orders);
+            }
+            orders.at(owner) = actions;
+            if (owner == 1) {
+                before = TrueState(referee);
+                pending = true;
+            }
+        };
+        referee.play({getActions, getActions});
+    }
+    cerr.rdbuf(debug);
+    cout << "apply mismatches against the referee: " << mismatches << " of " << steps << " turns\n";
+
+    static constexpr int ROUNDS = 20;
+    int checksum = 0;
+    auto start = chrono::steady_clock::now();
+    for (int r = 0; r < ROUNDS; r++) {
+        for (auto& turn : turns) {
+            GameState s = turn.first;
+            s.apply(turn.second);
+            checksum += s.score.at(0);
+        }
+    }
+    double ns = Elapsed(start) / max<size_t>(1, ROUNDS * turns.size());
+    cout << "GameState " << sizeof(GameState) << " bytes, copy+apply " << ns << " ns, " << 1e3 / ns << " M/s (" << checksum % 10 << ")\n";
+}
+
+void BenchKernels(int reps, uint32_t seed) {
+    streambuf* debug = cerr.rdbuf(nullptr);
+    Sweep("traps", {0, 10, 20, 30, 40, 50, 60}, [](BoardSpec& spec, double v) { spec.traps = (int)v; }, reps, seed);
+    Sweep("dangers", {0, 10, 20, 40, 80}, [](BoardSpec& spec, double v) { spec.dangers = (int)v; }, reps, seed);
+    Sweep("ore", {0, 0.1, 0.2, 0.4, 0.8}, [](BoardSpec& spec, double v) { spec.oreDensity = v; }, reps, seed);
+    Sweep("radars", {0, 3, 6, 9, 12}, [](BoardSpec& spec, double v) { spec.radars = (int)v; }, reps, seed);
+    cerr.rdbuf(debug);
+}
+
+#ifdef AI_ALLOC
+// self-play games with the heap calls of every phase per turn, false when the steady state is over budget
+bool BenchAlloc(int games, uint32_t seed, long long budget) {
+    static constexpr int WARMUP_TURNS = 3;  // buffers kept for the game may grow until then
+    profiler = Profiler{};
+    streambuf* debug = cerr.rdbuf(nullptr);
+    for (int g = 0; g < games; g++) {
+        Referee referee{seed + g};
+        referee.play({getActions, getActions});
+    }
+    cerr.rdbuf(debug);
+    profiler.dump(cout);
+    long long steady = profiler.steadyAllocs(WARMUP_TURNS);
+    bool pass = steady <= budget;
+    cout << "alloc      most allocations in a turn from turn " << WARMUP_TURNS << ": " << steady << ", budget " << budget
+         << (pass ? " ok" : " EXCEEDED") << "\n";
+    return pass;
+}
+#endif
+
+int main(int argc, char** argv) {
+    string suite = argc > 1 ? argv[1] : "all";
+    int reps = argc > 2 ? atoi(argv[2]) : 20;
+    uint32_t seed = argc > 3 ? (uint32_t)strtoul(argv[3], nullptr, 10) : 1;
+    if (suite == "parse" || suite == "all") {
+        vector<TurnInput> turns = CaptureTurns(reps * 100, seed);
+        cout << "turns: " << turns.size() << "\n";
+        BenchParse(turns);
+    }
+    if (suite == "kernels" || suite == "all") BenchKernels(reps, seed);
+    if (suite == "forward" || suite == "all") BenchForward(reps, seed);
+#ifdef AI_ALLOC
+    long long budget = argc > 4 ? atoll(argv[4]) : 0;
+    if ((suite == "alloc" || suite == "all") && !BenchAlloc(reps, seed, budget)) return 1;
+#else
+    if (suite == "alloc") cout << "alloc      build with -DAI_ALLOC\n";
+#endif
+}
@@ -0,0 +1,73 @@
+// Local bot-vs-bot matches with the headless referee.
+//     g++ -std=c++17 -O2 Match.cpp -o match
+//     ./match [games=1] [seed=1] [record prefix] [-e expansions]
+// -e runs the plan search in seat 0 capped at that many expansions a turn, seat 1 stays greedy
+// add -DAI_RECORD and a prefix to log every seat as <prefix><seed>_<player>.rec for Replay.cpp
+// add -DAI_PROFILE for the per-phase turn profile of both seats over all games
+// add -DAI_ALLOC for the heap allocations, frees and bytes of every phase per turn on top of it
+#define AI_NO_MAIN
+#include "AI.cpp"
+#include "Referee.h"
+
+int main(int argc, char** argv) {
+    vector<string> args;
+    int expansions = 0;
+    for (int i = 1; i < argc; i++) {
+        if (string(argv[i]) == "-e" && i + 1 < argc) expansions = atoi(argv[++i]);
+        else args.push_back(argv[i]);
+    }
+    int games = args.size() > 0 ? stoi(args.at(0)) : 1;
+    uint32_t seed = args.size() > 1 ? (uint32_t)stoul(args.at(1)) : 1;
+    string recordPrefix = args.size() > 2 ? args.at(2) : "";
+    Bot searcher = [expansions](BotContext& bot, Game& game) {
+        if (expansions > 0) bot.searchBudget.limit(expansions);
+        return getActions(bot, game);
+    };
+
+    // the bot debug output would dominate the run time
+    streambuf* debug = cerr.rdbuf(nullptr);
+
+    array<int, 3> wins{};  // player 0, player 1, draw
+    array<long long, MAX_PLAYERS> score{};
+    array<double, MAX_PLAYERS> avgMs{};
+    array<double, MAX_PLAYERS> maxMs{};
+    long long turns = 0;
+    auto start = chrono::steady_clock::now();
+    for (int g = 0; g < games; g++) {
+        Referee referee{seed + g};
+#ifdef AI_RECORD
+        array<TurnRecorder, MAX_PLAYERS> recorders;
+        if (!recordPrefix.empty()) {
+            for (int owner = 0; owner < MAX_PLAYERS; owner++) {
+                recorders.at(owner).open(recordPrefix + to_string(seed + g) + "_" + to_string(owner) + ".rec", MAX_WIDTH, MAX_HEIGHT);
+            }
+            referee.onTurn = [&](int owner, const TurnInput& input, uint32_t rng, const array<Action, MAX_ROBOTS>& actions) {
+                recorders.at(owner).write(input, rng, actions);
+            };
+        }
+#endif
+        MatchResult result = referee.play({searcher, getActions});
+        int winner = result.winner();
+        wins.at(winner == -1 ? 2 : winner)++;
+        turns += result.turns;
+        for (int owner = 0; owner < MAX_PLAYERS; owner++) {
+            score.at(owner) += result.score.at(owner);
+            avgMs.at(owner) += result.avgMs.at(owner);
+            maxMs.at(owner) = max(maxMs.at(owner), result.maxMs.at(owner));
+        }
+        cout << "seed " << seed + g << ": " << result.score.at(0) << " - " << result.score.at(1) << " in " << result.turns
+             << " turns, lost " << result.robotsLost.at(0) << " - " << result.robotsLost.at(1) << " robots\n";
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cerr.rdbuf(debug);
+    PROFILE_DUMP();
+
+    if (games <= 0) return 0;
+    cout << "games: " << games << " wins: " << wins.at(0) << " - " << wins.at(1) << " draws: " << wins.at(2) << "\n";
+    cout << "avg turns: " << (double)turns / games << "\n";
+    for (int owner = 0; owner < MAX_PLAYERS; owner++) {
+        cout << "player " << owner << " avg score: " << (double)score.at(owner) / games << " decision avg "
+             << avgMs.at(owner) / games << " ms, max " << maxMs.at(owner) << " ms\n";
+    }
+    cout << "throughput: " << games / seconds * 60 << " games/min\n";
+}
@@ -0,0 +1,323 @@
+// Headless referee for Unleash The Geek, plays full matches in-process against getActions.
+// Include after AI.cpp with its main compiled out:
+//     #define AI_NO_MAIN
+//     #include "AI.cpp"
+//     #include "Referee.h"
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <random>
+#include <string>
+
+using Bot = function<array<Action, MAX_ROBOTS>(BotContext&, Game&)>;
+using TurnActions = array<array<Action, MAX_ROBOTS>, MAX_PLAYERS>;
+
+//----------------------------------MatchResult----------------------------------------------------------
+struct MatchResult {
+    array<int, MAX_PLAYERS> score{};
+    array<int, MAX_PLAYERS> robotsLost{};
+    array<double, MAX_PLAYERS> avgMs{};  // per-turn decision time
+    array<double, MAX_PLAYERS> maxMs{};
+    int turns{0};
+
+    // -1 for draw
+    int winner() const {
+        if (score.at(0) == score.at(1)) return -1;
+        return score.at(0) > score.at(1) ? 0 : 1;
+    }
+};
+
+//----------------------------------Referee----------------------------------------------------------
+struct Referee {
+    Grid grid;  // ore is the real amount
+    array<Player, MAX_PLAYERS> players;
+    vector<Entity> radars;  // owner is the player who buried it
+    vector<Entity> traps;
+    int turn{0};
+    int nextId{MAX_PLAYERS * MAX_ROBOTS};
+    uint32_t seed;
+    mt19937 rng;
+
+    explicit Referee(uint32_t _seed) : seed{_seed}, rng{_seed} { generate(); }
+
+    static bool inside(Point p) { return p.x >= 0 && p.x < MAX_WIDTH && p.y >= 0 && p.y < MAX_HEIGHT; }
+    Cell get(Point p) { return grid.get(p); }
+
+    void generate() {
+        grid = Grid{};
+        for (int i = 0; i < Grid::CELLS; i++) grid[i].update(0, true, 0);
+        // ore veins, a cluster is a radius 2 diamond, none close to base
+        uniform_real_distribution<double> density(ORE_VEIN_DENSITY_MIN, ORE_VEIN_DENSITY_MAX);
+        int clusters = (int)(MAX_WIDTH * MAX_HEIGHT * density(rng));
+        for (int c = 0; c < clusters; c++) {
+            Point center{ORE_VEIN_MIN_X + (int)(rng() % (MAX_WIDTH - ORE_VEIN_MIN_X)), (int)(rng() % MAX_HEIGHT)};
+            for (int x = center.x - ORE_VEIN_RANGE; x <= center.x + ORE_VEIN_RANGE; x++) {
+                for (int y = center.y - ORE_VEIN_RANGE; y <= center.y + ORE_VEIN_RANGE; y++) {
+                    Point p{x, y};
+                    if (x < 1 || !inside(p) || center.distance(p) > ORE_VEIN_RANGE) continue;
+                    if (rng() % 2 == 0) continue;
+                    get(p).ore = min(get(p).ore + 1 + (int)(rng() % MAX_ORE), MAX_ORE);
+                }
+            }
+        }
+        // both team start on the same rows of the base
+        array<int, MAX_HEIGHT> rows;
+        for (int y = 0; y < MAX_HEIGHT; y++) rows.at(y) = y;
+        shuffle(rows.begin(), rows.end(), rng);
+        for (int owner = 0; owner < MAX_PLAYERS; owner++) {
+            players.at(owner) = Player{};
+            players.at(owner).owner = owner;
+            for (int i = 0; i < MAX_ROBOTS; i++) {
+                players.at(owner).robots.at(i).update(owner * MAX_ROBOTS + i, Type::ROBOT, Point{0, rows.at(i)}, Type::NONE, owner);
+            }
+        }
+    }
+
+    bool visible(int owner, Point p) {
+        for (Entity& radar : radars) {
+            if (radar.owner == owner && radar.distance(p) <= RADAR_RANGE) return true;
+        }
+        return false;
+    }
+
+    int trapAt(Point p) {
+        for (size_t j = 0; j < traps.size(); j++) {
+            if (traps.at(j).distance(p) == 0) return (int)j;
+        }
+        return -1;
+    }
+
+    int oreLeft() {
+        int ore = 0;
+        for (int x = 1; x < MAX_WIDTH; x++) {
+            for (int y = 0; y < MAX_HEIGHT; y++) ore += grid.ore[Bitboard::index(x, y)];
+        }
+        return ore;
+    }
+
+    int robotsAlive(int owner) {
+        int count = 0;
+        for (Robot& robot : players.at(owner).robots) count += !robot.isDead();
+        return count;
+    }
+
+    bool isOver() {
+        if (turn >= MAX_TURNS) return true;
+        if (robotsAlive(0) == 0 && robotsAlive(1) == 0) return true;
+        // nothing left to bring home
+        if (oreLeft() > 0) return false;
+        for (Player& player : players) {
+            for (Robot& robot : player.robots) {
+                if (robot.item == Type::ORE) return false;
+            }
+        }
+        return true;
+    }
+
+    static int itemCode(Type item) {
+        switch (item) {
+        case Type::RADAR: return 2;
+        case Type::TRAP:  return 3;
+        case Type::ORE:   return 4;
+        default:          return -1;
+        }
+    }
+
+    // what main() would read from stdin for this owner
+    TurnInput observe(int owner) {
+        TurnInput input;
+        Player& me{players.at(owner)};
+        Player& enemy{players.at(1 - owner)};
+        input.myOre = me.ore;
+        input.enemyOre = enemy.ore;
+        for (int y = 0; y < MAX_HEIGHT; y++) {
+            for (int x = 0; x < MAX_WIDTH; x++) {
+                Cell cell{grid.get(x, y)};
+                input.ore[y][x] = visible(owner, Point{x, y}) ? cell.ore : -1;
+                input.hole[y][x] = cell.hole;
+            }
+        }
+        input.radarCooldown = me.cooldownRadar;
+        input.trapCooldown = me.cooldownTrap;
+        for (int p = 0; p < MAX_PLAYERS; p++) {
+            for (Robot& robot : players.at(p).robots) {
+                int item = p == owner ? itemCode(robot.item) : -1;
+                input.entities.push_back({robot.id, p == owner ? 0 : 1, robot.x, robot.y, item});
+            }
+        }
+        for (Entity& radar : radars) {
+            if (radar.owner == owner) input.entities.push_back({radar.id, 2, radar.x, radar.y, -1});
+        }
+        for (Entity& trap : traps) {
+            if (trap.owner == owner) input.entities.push_back({trap.id, 3, trap.x, trap.y, -1});
+        }
+        return input;
+    }
+
+    // cell within range of from closest to dest, straight line first on ties
+    static Point stepToward(Point from, Point dest, int range) {
+        if (from.distance(dest) <= range) return dest;
+        Point best = from;
+        int bestDist = from.distance(dest);
+        int bestLine = 0;
+        for (int x = from.x - range; x <= from.x + range; x++) {
+            for (int y = from.y - range; y <= from.y + range; y++) {
+                Point p{x, y};
+                if (!inside(p) || from.distance(p) > range) continue;
+                int dist = p.distance(dest);
+                int line = (dest.x - x) * (dest.x - x) + (dest.y - y) * (dest.y - y);
+                if (dist < bestDist || (dist == bestDist && line < bestLine)) {
+                    best = p;
+                    bestDist = dist;
+                    bestLine = line;
+                }
+            }
+        }
+        return best;
+    }
+
+    void kill(Robot& robot) {
+        robot.x = -1;
+        robot.y = -1;
+        robot.item = Type::NONE;
+    }
+
+    void explode(vector<Point> triggered) {
+        while (!triggered.empty()) {
+            Point p = triggered.back();
+            triggered.pop_back();
+            int index = trapAt(p);
+            if (index == -1) continue;  // already gone off in this chain
+            traps.erase(traps.begin() + index);
+            for (Player& player : players) {
+                for (Robot& robot : player.robots) {
+                    if (!robot.isDead() && robot.distance(p) <= TRAP_RANGE) kill(robot);
+                }
+            }
+            for (Entity& trap : traps) {
+                if (trap.distance(p) <= TRAP_RANGE) triggered.push_back(trap);
+            }
+        }
+    }
+
+    // resolve one turn: requests, digs, trap explosions, moves then delivery
+    void step(const TurnActions& actions) {
+        for (int owner = 0; owner < MAX_PLAYERS; owner++) {
+            Player& player{players.at(owner)};
+            for (int i = 0; i < MAX_ROBOTS; i++) {
+                Robot& robot{player.robots.at(i)};
+                const Action& action{actions.at(owner).at(i)};
+                if (robot.isDead() || action.type != ActionType::REQUEST || robot.x != 0) continue;
+                if (action.item == Type::RADAR && player.cooldownRadar == 0) {
+                    robot.item = Type::RADAR;
+                    player.cooldownRadar = ITEM_COOLDOWN;
+                }
+                if (action.item == Type::TRAP && player.cooldownTrap == 0) {
+                    robot.item = Type::TRAP;
+                    player.cooldownTrap = ITEM_COOLDOWN;
+                }
+            }
+        }
+
+        vector<Point> triggered;
+        for (int owner = 0; owner < MAX_PLAYERS; owner++) {
+            for (int i = 0; i < MAX_ROBOTS; i++) {
+                Robot& robot{players.at(owner).robots.at(i)};
+                Point dest = actions.at(owner).at(i).dest;
+                if (robot.isDead() || actions.at(owner).at(i).type != ActionType::DIG) continue;
+                if (dest.x < 1 || !inside(dest) || robot.distance(dest) > 1) continue;
+                if (trapAt(dest) != -1) {
+                    triggered.push_back(dest);
+                    continue;
+                }
+                Cell cell{get(dest)};
+                cell.hole = true;
+                // digging out an enemy radar destroy it
+                radars.erase(remove_if(radars.begin(), radars.end(), [&](Entity& radar) {
+                    return radar.owner != owner && radar.distance(dest) == 0;
+                }), radars.end());
+                if (robot.item == Type::RADAR) radars.emplace_back(nextId++, Type::RADAR, dest, Type::NONE, owner);
+                if (robot.item == Type::TRAP) traps.emplace_back(nextId++, Type::TRAP, dest, Type::NONE, owner);
+                if (robot.item == Type::RADAR || robot.item == Type::TRAP) robot.item = Type::NONE;
+                if (robot.item == Type::NONE && cell.ore > 0) {
+                    cell.ore--;
+                    robot.item = Type::ORE;
+                }
+            }
+        }
+        explode(triggered);
+
+        for (int owner = 0; owner < MAX_PLAYERS; owner++) {
+            for (int i = 0; i < MAX_ROBOTS; i++) {
+                Robot& robot{players.at(owner).robots.at(i)};
+                const Action& action{actions.at(owner).at(i)};
+                if (robot.isDead() || !inside(action.dest)) continue;
+                Point p = robot;
+                if (action.type == ActionType::MOVE) {
+                    p = stepToward(robot, action.dest, MOVE_RANGE);
+                }
+                if (action.type == ActionType::DIG && robot.distance(action.dest) > DIG_RANGE) {
+                    p = stepToward(robot, action.dest, min(MOVE_RANGE, robot.distance(action.dest) - 1));
+                }
+                robot.x = p.x;
+                robot.y = p.y;
+            }
+        }
+
+        for (Player& player : players) {
+            for (Robot& robot : player.robots) {
+                if (robot.x == 0 && robot.item == Type::ORE) {
+                    player.ore++;
+                    robot.item = Type::NONE;
+                }
+            }
+            if (player.cooldownRadar > 0) player.cooldownRadar--;
+            if (player.cooldownTrap > 0) player.cooldownTrap--;
+        }
+        turn++;
+    }
+
+    // constants each seat plays with, set before play()
+    array<Params, MAX_PLAYERS> params;
+
+    // called for each seat every turn with its input, bot random state before thinking and its actions
+    function<void(int owner, const TurnInput& input, uint32_t rng, const array<Action, MAX_ROBOTS>& actions)> onTurn;
+
+    MatchResult play(const array<Bot, MAX_PLAYERS>& bots) {
+        MatchResult result;
+        array<BotContext, MAX_PLAYERS> contexts;
+        array<Game, MAX_PLAYERS> views;
+        array<double, MAX_PLAYERS> totalMs{};
+        for (int owner = 0; owner < MAX_PLAYERS; owner++) {
+            contexts.at(owner).rngState = seed * 2654435761u + owner + 1;
+            contexts.at(owner).params = params.at(owner);
+            views.at(owner).initScore(params.at(owner));
+        }
+
+        while (!isOver()) {
+            TurnActions actions;
+            for (int owner = 0; owner < MAX_PLAYERS; owner++) {
+                TurnInput input = observe(owner);
+                views.at(owner).reset();
+                input.apply(views.at(owner));
+                uint32_t rng = contexts.at(owner).rngState;
+                auto start = chrono::steady_clock::now();
+                actions.at(owner) = bots.at(owner)(contexts.at(owner), views.at(owner));
+                double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+                if (onTurn) onTurn(owner, input, rng, actions.at(owner));
+                totalMs.at(owner) += ms;
+                result.maxMs.at(owner) = max(result.maxMs.at(owner), ms);
+            }
+            step(actions);
+        }
+
+        result.turns = turn;
+        for (int owner = 0; owner < MAX_PLAYERS; owner++) {
+            result.score.at(owner) = players.at(owner).ore;
+            result.robotsLost.at(owner) = MAX_ROBOTS - robotsAlive(owner);
+            result.avgMs.at(owner) = turn > 0 ? totalMs.at(owner) / turn : 0;
+        }
+        return result;
+    }
+};
@@ -0,0 +1,78 @@
+// Feed recorded games back through getActions at full speed, check the decisions still match the log.
+//     g++ -std=c++17 -O2 -DAI_RECORD Replay.cpp -o replay
+//     ./replay [-v] [-t turn] game.rec...
+// -v print every turn where the actions differ, -t print the actions of one turn.
+// Add -DAI_PROFILE for the per-phase profile over every replayed turn. Games played with $AI_PARAMS
+// replay with the same file set.
+#ifndef AI_RECORD
+#define AI_RECORD
+#endif
+#define AI_NO_MAIN
+#include "AI.cpp"
+#include "Referee.h"
+
+bool SameAction(const Action& a, const Action& b) {
+    return a.type == b.type && a.item == b.item && a.dest.x == b.dest.x && a.dest.y == b.dest.y && a.message == b.message;
+}
+
+int main(int argc, char** argv) {
+    bool verbose = false;
+    int showTurn = -1;
+    vector<string> paths;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "-v") verbose = true;
+        else if (arg == "-t" && i + 1 < argc) showTurn = atoi(argv[++i]);
+        else paths.push_back(arg);
+    }
+
+    streambuf* debug = cerr.rdbuf(nullptr);
+    int games = 0;
+    long long turns = 0, mismatches = 0;
+    double thinkMs = 0;
+    auto start = chrono::steady_clock::now();
+    for (const string& path : paths) {
+        TurnReader reader;
+        if (!reader.open(path)) {
+            cout << path << ": not a turn log\n";
+            continue;
+        }
+        games++;
+        BotContext bot;
+        if (getenv("AI_PARAMS")) {
+            ifstream file(getenv("AI_PARAMS"));
+            bot.params.load(file);
+        }
+        Game game;
+        game.initScore(bot.params);
+        TurnInput input;
+        uint32_t rng;
+        array<Action, MAX_ROBOTS> recorded;
+        while (reader.read(input, rng, recorded)) {
+            game.reset();
+            input.apply(game);
+            bot.rngState = rng;
+            auto think = chrono::steady_clock::now();
+            array<Action, MAX_ROBOTS> actions = getActions(bot, game);
+            thinkMs += chrono::duration<double, milli>(chrono::steady_clock::now() - think).count();
+            turns++;
+
+            bool same = true;
+            for (int i = 0; i < MAX_ROBOTS; i++) same = same && SameAction(actions.at(i), recorded.at(i));
+            mismatches += !same;
+            if ((verbose && !same) || game.turn == showTurn) {
+                cout << path << " turn " << game.turn << (same ? "" : " differs") << "\n";
+                for (int i = 0; i < MAX_ROBOTS; i++) cout << "  " << recorded.at(i) << " | " << actions.at(i) << "\n";
+            }
+        }
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cerr.rdbuf(debug);
+    PROFILE_DUMP();
+
+    cout << "games: " << games << " turns: " << turns << " differing turns: " << mismatches << "\n";
+    if (turns > 0) {
+        cout << "think avg: " << thinkMs * 1000 / turns << " us/turn, replay: " << turns / seconds << " turns/s\n";
+    }
+    return mismatches == 0 ? 0 : 1;
+}
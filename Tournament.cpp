@@ -0,0 +1,274 @@
+// Self-play tournament: the current getActions against a baseline over many seeds, each seed played
+// from both seats, games spread over every core.
+//     g++ -std=c++17 -O2 -pthread Tournament.cpp -o tournament
+//     ./tournament [games=1000] [baseline=self] [seed=1] [threads=all cores] [-e expansions]
+// baseline is self (the current bot in the other seat), miner (scripted) or the path of a frozen
+// build of the bot, e.g. git show <commit>:AI.cpp > old.cpp && g++ -std=c++17 -O2 old.cpp -o frozen
+// -e runs the plan search in the current bot capped at that many expansions a turn, against a greedy
+// self baseline that is the search's measured gain
+// prints win rate, the Elo difference with its 95% interval and the decision latency percentiles
+#define AI_NO_MAIN
+#include "AI.cpp"
+#include "Referee.h"
+
+#include <atomic>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <fcntl.h>
+#include <iomanip>
+#include <sys/wait.h>
+#include <thread>
+
+//*********************************  BASELINES  **********************************************
+
+// digs the closest ore it sees, else a fresh random cell, robot 0 keeps radars going
+array<Action, MAX_ROBOTS> Miner(BotContext& bot, Game& game) {
+    static const array<Point, 8> RADARS{Point{5, 3}, Point{5, 11}, Point{10, 7}, Point{14, 3},
+                                        Point{14, 11}, Point{19, 7}, Point{23, 3}, Point{23, 11}};
+    Player& me = game.players.at(0);
+    array<Action, MAX_ROBOTS> actions;
+    Bitboard taken;
+    for (int i = 0; i < MAX_ROBOTS; i++) {
+        Robot& robot = me.robots.at(i);
+        Action& action = actions.at(i);
+        if (robot.isDead()) continue;
+        if (robot.item == Type::ORE) {
+            action.move(Point{0, robot.y});
+            continue;
+        }
+        if (robot.item == Type::RADAR) {
+            for (Point p : RADARS) {
+                if (!game.radarMask.test(p)) {
+                    action.dig(p);
+                    break;
+                }
+            }
+            if (action.type == ActionType::DIG) continue;
+        }
+        if (i == 0 && robot.x == 0 && robot.item == Type::NONE && me.cooldownRadar == 0 && game.radarMask.count() < (int)RADARS.size()) {
+            action.request(Type::RADAR);
+            continue;
+        }
+        Point dest{-1, -1};
+        game.oreMask.andNot(game.trapMask).andNot(taken).forEach([&](Point p) {
+            if (dest.x == -1 || robot.distance(p) < robot.distance(dest)) dest = p;
+        });
+        if (dest.x == -1) {
+            // blind, stay on last turn's cell until someone digs it
+            Point last = bot.prevActions.at(i).dest;
+            if (bot.prevActions.at(i).type == ActionType::DIG && Bitboard::inside(last.x, last.y) && !game.get(last).hole && !taken.test(last)) {
+                dest = last;
+            }
+            for (int tries = 0; dest.x == -1 || (tries < 20 && (game.get(dest).hole || taken.test(dest))); tries++) {
+                dest = Point{bot.roll(ORE_VEIN_MIN_X, MAX_WIDTH), bot.roll(0, MAX_HEIGHT)};
+            }
+        }
+        taken.set(dest);
+        action.dig(dest);
+    }
+    bot.prevActions = actions;
+    return actions;
+}
+
+// a frozen build of the bot with its own main, fed over pipes exactly like the CodinGame referee
+struct ProcessBot {
+    pid_t pid{-1};
+    FILE* in{nullptr};   // its stdin
+    FILE* out{nullptr};  // its stdout
+
+    bool start(const string& path) {
+        int toBot[2], fromBot[2];
+        // close on exec, a bot forked by another worker must not hold our pipe ends open
+        if (pipe2(toBot, O_CLOEXEC) != 0 || pipe2(fromBot, O_CLOEXEC) != 0) return false;
+        pid = fork();
+        if (pid == 0) {
+            dup2(toBot[0], 0);
+            dup2(fromBot[1], 1);
+            // only async-signal-safe calls until exec, another worker may hold the malloc lock
+            int null = open("/dev/null", O_WRONLY);
+            if (null >= 0) {
+                dup2(null, 2);
+                close(null);
+            }
+            close(toBot[1]);
+            close(fromBot[0]);
+            execl(path.c_str(), path.c_str(), (char*)nullptr);
+            _exit(127);
+        }
+        close(toBot[0]);
+        close(fromBot[1]);
+        in = fdopen(toBot[1], "w");
+        out = fdopen(fromBot[0], "r");
+        fprintf(in, "%d %d\n", MAX_WIDTH, MAX_HEIGHT);
+        return pid > 0;
+    }
+    ~ProcessBot() {
+        if (in) fclose(in);
+        if (out) fclose(out);
+        if (pid > 0) {
+            kill(pid, SIGKILL);
+            waitpid(pid, nullptr, 0);
+        }
+    }
+
+    array<Action, MAX_ROBOTS> play(const TurnInput& input) {
+        fprintf(in, "%d %d\n", input.myOre, input.enemyOre);
+        for (int y = 0; y < MAX_HEIGHT; y++) {
+            for (int x = 0; x < MAX_WIDTH; x++) {
+                if (input.ore[y][x] == -1) fputs("?", in);
+                else fprintf(in, "%d", input.ore[y][x]);
+                fprintf(in, " %d%c", input.hole[y][x], x + 1 == MAX_WIDTH ? '\n' : ' ');
+            }
+        }
+        fprintf(in, "%d %d %d\n", (int)input.entities.size(), input.radarCooldown, input.trapCooldown);
+        for (const TurnInput::EntityInput& e : input.entities) fprintf(in, "%d %d %d %d %d\n", e.id, e.type, e.x, e.y, e.item);
+        fflush(in);
+
+        // WAIT|MOVE x y|DIG x y|REQUEST item, anything after is the message
+        array<Action, MAX_ROBOTS> actions;
+        char line[256];
+        for (Action& action : actions) {
+            if (!fgets(line, sizeof line, out)) break;
+            char word[16], item[16];
+            Point p;
+            if (sscanf(line, "%15s", word) != 1) continue;
+            string type = word;
+            if ((type == "MOVE" || type == "DIG") && sscanf(line, "%*s %d %d", &p.x, &p.y) == 2) {
+                if (type == "MOVE") action.move(p);
+                else action.dig(p);
+            }
+            else if (type == "REQUEST" && sscanf(line, "%*s %15s", item) == 1) {
+                action.request(string(item) == "TRAP" ? Type::TRAP : Type::RADAR);
+            }
+        }
+        return actions;
+    }
+};
+
+//*********************************  TOURNAMENT  **********************************************
+
+struct Outcome {
+    int result{0};  // 1 win, 0 draw, -1 loss for the current bot
+    int score{0}, baselineScore{0};
+};
+
+// per-turn decision time of one side, µs
+struct Latencies {
+    vector<double> us;
+
+    void add(const Latencies& oth) { us.insert(us.end(), oth.us.begin(), oth.us.end()); }
+    double percentile(double q) {
+        if (us.empty()) return 0;
+        size_t k = min(us.size() - 1, (size_t)(q * us.size()));
+        nth_element(us.begin(), us.begin() + k, us.end());
+        return us.at(k);
+    }
+};
+
+// game g is seed + g / 2 with the current bot in seat g % 2
+Outcome PlayGame(int g, uint32_t seed, const string& baseline, int expansions, Latencies& current, Latencies& other) {
+    Referee referee{seed + g / 2};
+    int seat = g % 2;
+    auto timed = [](Latencies& latencies, auto decide) {
+        auto start = chrono::steady_clock::now();
+        array<Action, MAX_ROBOTS> actions = decide();
+        latencies.us.push_back(chrono::duration<double, micro>(chrono::steady_clock::now() - start).count());
+        return actions;
+    };
+    Bot bot = [&](BotContext& context, Game& game) {
+        if (expansions > 0) context.searchBudget.limit(expansions);
+        return timed(current, [&] { return getActions(context, game); });
+    };
+    Bot opponent;
+    ProcessBot process;
+    if (baseline == "self") {
+        opponent = [&](BotContext& context, Game& game) { return timed(other, [&] { return getActions(context, game); }); };
+    }
+    else if (baseline == "miner") {
+        opponent = [&](BotContext& context, Game& game) { return timed(other, [&] { return Miner(context, game); }); };
+    }
+    else {
+        if (!process.start(baseline)) return Outcome{};
+        opponent = [&](BotContext&, Game&) { return timed(other, [&] { return process.play(referee.observe(1 - seat)); }); };
+    }
+    MatchResult result = seat == 0 ? referee.play({bot, opponent}) : referee.play({opponent, bot});
+    Outcome outcome;
+    outcome.score = result.score.at(seat);
+    outcome.baselineScore = result.score.at(1 - seat);
+    outcome.result = outcome.score > outcome.baselineScore ? 1 : outcome.score < outcome.baselineScore ? -1 : 0;
+    return outcome;
+}
+
+// Elo difference for a score rate
+double Elo(double rate) {
+    rate = min(max(rate, 1e-6), 1 - 1e-6);
+    return -400 * log10(1 / rate - 1);
+}
+
+int main(int argc, char** argv) {
+    vector<string> args;
+    int expansions = 0;
+    for (int i = 1; i < argc; i++) {
+        if (string(argv[i]) == "-e" && i + 1 < argc) expansions = atoi(argv[++i]);
+        else args.push_back(argv[i]);
+    }
+    int games = args.size() > 0 ? stoi(args.at(0)) : 1000;
+    string baseline = args.size() > 1 ? args.at(1) : "self";
+    uint32_t seed = args.size() > 2 ? (uint32_t)stoul(args.at(2)) : 1;
+    int threads = args.size() > 3 ? stoi(args.at(3)) : (int)thread::hardware_concurrency();
+    threads = max(1, min(threads, games));
+    if (baseline != "self" && baseline != "miner" && access(baseline.c_str(), X_OK) != 0) {
+        cout << "baseline " << baseline << ": not self, miner or an executable\n";
+        return 1;
+    }
+    // the frozen bot may exit early, its pipe must not take us down
+    signal(SIGPIPE, SIG_IGN);
+
+    // the bot debug output would dominate the run time
+    streambuf* debug = cerr.rdbuf(nullptr);
+
+    // workers take the next unplayed game until none is left, slow games do not hold the others back
+    vector<Outcome> outcomes(games);
+    vector<Latencies> current(threads), other(threads);
+    atomic<int> next{0};
+    auto start = chrono::steady_clock::now();
+    vector<thread> pool;
+    for (int t = 0; t < threads; t++) {
+        pool.emplace_back([&, t] {
+            for (int g = next++; g < games; g = next++) outcomes.at(g) = PlayGame(g, seed, baseline, expansions, current.at(t), other.at(t));
+        });
+    }
+    for (thread& worker : pool) worker.join();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cerr.rdbuf(debug);
+
+    array<int, 3> count{};  // loss, draw, win
+    double score = 0, baselineScore = 0;
+    for (const Outcome& outcome : outcomes) {
+        count.at(outcome.result + 1)++;
+        score += outcome.score;
+        baselineScore += outcome.baselineScore;
+    }
+    // score rate and its standard error from the per-game spread
+    double rate = (count.at(2) + 0.5 * count.at(1)) / games;
+    double variance = (count.at(2) * pow(1 - rate, 2) + count.at(1) * pow(0.5 - rate, 2) + count.at(0) * pow(rate, 2)) / games;
+    double margin = 1.96 * sqrt(variance / games);
+
+    cout << fixed << setprecision(1);
+    cout << "games: " << games << (expansions > 0 ? " searching " + to_string(expansions) + " expansions" : "") << " vs " << baseline << " on " << threads << " threads, " << games / seconds * 60 << " games/min\n";
+    cout << "wins: " << count.at(2) << " draws: " << count.at(1) << " losses: " << count.at(0) << " score rate: " << 100 * rate
+         << "% +- " << 100 * margin << "%\n";
+    cout << "elo: " << Elo(rate) << " [" << Elo(rate - margin) << ", " << Elo(rate + margin) << "]\n";
+    cout << "avg ore: " << score / games << " vs " << baselineScore / games << "\n";
+    Latencies all, allOther;
+    for (int t = 0; t < threads; t++) {
+        all.add(current.at(t));
+        allOther.add(other.at(t));
+    }
+    for (auto side : {make_pair("getActions", &all), make_pair("baseline", &allOther)}) {
+        Latencies& latencies = *side.second;
+        cout << side.first << " us/turn p50 " << latencies.percentile(0.5) << " p90 " << latencies.percentile(0.9) << " p99 "
+             << latencies.percentile(0.99) << " max " << latencies.percentile(1) << "\n";
+    }
+}
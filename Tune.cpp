@@ -0,0 +1,147 @@
+// SPSA tuner for the bot Params. Each iteration moves every constant one step up or down at random,
+// plays that set against the opposite move in self-play over every core, and moves the constants
+// toward the side that scored better.
+//     g++ -std=c++17 -O2 -pthread Tune.cpp -o tune
+//     ./tune [iterations=50] [games=400] [seed=1] [threads=all cores] [out=params.txt] [-w]
+// games per iteration are seed pairs played from both seats, the running set is saved to out after
+// every iteration (load it with $AI_PARAMS), -w writes the result into the Params defaults of AI.cpp
+#define AI_NO_MAIN
+#include "AI.cpp"
+#include "Referee.h"
+
+#include <atomic>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <regex>
+#include <sstream>
+#include <thread>
+
+// constants as a point in [0,1] per field, ints round on the way back
+vector<double> Normalize(Params params) {
+    vector<double> x;
+    params.forEach([&](const char*, auto& value, double lo, double hi) { x.push_back((value - lo) / (hi - lo)); });
+    return x;
+}
+
+Params Denormalize(const vector<double>& x) {
+    Params params;
+    int i = 0;
+    params.forEach([&](const char*, auto& value, double lo, double hi) {
+        double v = lo + min(max(x.at(i++), 0.0), 1.0) * (hi - lo);
+        value = is_integral<remove_reference_t<decltype(value)>>::value ? round(v) : v;
+    });
+    return params;
+}
+
+// score rate of a against b over games, game g is seed + g / 2 with a in seat g % 2
+double PlayMatch(const Params& a, const Params& b, int games, uint32_t seed, int threads) {
+    vector<double> points(games);
+    atomic<int> next{0};
+    vector<thread> pool;
+    for (int t = 0; t < threads; t++) {
+        pool.emplace_back([&] {
+            for (int g = next++; g < games; g = next++) {
+                Referee referee{seed + g / 2};
+                int seat = g % 2;
+                referee.params.at(seat) = a;
+                referee.params.at(1 - seat) = b;
+                MatchResult result = referee.play({getActions, getActions});
+                int diff = result.score.at(seat) - result.score.at(1 - seat);
+                points.at(g) = diff > 0 ? 1 : diff < 0 ? 0 : 0.5;
+            }
+        });
+    }
+    for (thread& worker : pool) worker.join();
+    double total = 0;
+    for (double p : points) total += p;
+    return total / max(games, 1);
+}
+
+// new defaults into the Params block of the source, each "type name{value};" keeps its comment
+bool WriteDefaults(const string& path, Params params) {
+    ifstream in(path);
+    if (!in) return false;
+    stringstream text;
+    text << in.rdbuf();
+    string source = text.str();
+    size_t begin = source.find("struct Params {");
+    size_t end = source.find("\n};", begin);
+    if (begin == string::npos || end == string::npos) return false;
+    string block = source.substr(begin, end - begin);
+    params.forEach([&](const char* name, auto& value, double, double) {
+        ostringstream v;
+        v << value;
+        string literal = v.str();
+        if (is_floating_point<remove_reference_t<decltype(value)>>::value) {
+            if (literal.find('.') == string::npos) literal += ".0";
+            literal += "f";
+        }
+        smatch field;
+        if (regex_search(block, field, regex(string("\\b") + name + "\\{([^}]*)\\};"))) {
+            block.replace(field.position(1), field.length(1), literal);
+        }
+    });
+    ofstream out(path);
+    out << source.substr(0, begin) << block << source.substr(end);
+    return (bool)out;
+}
+
+int main(int argc, char** argv) {
+    vector<string> args;
+    bool write = false;
+    for (int i = 1; i < argc; i++) {
+        if (string(argv[i]) == "-w") write = true;
+        else args.push_back(argv[i]);
+    }
+    int iterations = args.size() > 0 ? stoi(args.at(0)) : 50;
+    int games = args.size() > 1 ? stoi(args.at(1)) : 400;
+    uint32_t seed = args.size() > 2 ? (uint32_t)stoul(args.at(2)) : 1;
+    int threads = args.size() > 3 ? stoi(args.at(3)) : (int)thread::hardware_concurrency();
+    string outPath = args.size() > 4 ? args.at(4) : "params.txt";
+    threads = max(1, threads);
+    games += games % 2;
+
+    // SPSA gains, steps shrink as a / (k + 1 + A)^0.602 and probes as c / (k + 1)^0.101
+    static constexpr double A_GAIN = 0.1;
+    static constexpr double C_GAIN = 0.1;  // probe a tenth of every range
+    const double stability = 0.1 * iterations;
+
+    streambuf* debug = cerr.rdbuf(nullptr);
+    mt19937 rng{seed};
+    Params start;
+    vector<double> x = Normalize(start);
+    auto begin = chrono::steady_clock::now();
+    for (int k = 0; k < iterations; k++) {
+        double a = A_GAIN / pow(k + 1 + stability, 0.602);
+        double c = C_GAIN / pow(k + 1, 0.101);
+        vector<double> delta(x.size()), plus(x), minus(x);
+        for (size_t i = 0; i < x.size(); i++) {
+            delta.at(i) = rng() % 2 ? 1 : -1;
+            plus.at(i) += c * delta.at(i);
+            minus.at(i) -= c * delta.at(i);
+        }
+        // fresh seeds every iteration, the rate of plus against minus is f(plus) - f(minus) shifted by a half
+        double rate = PlayMatch(Denormalize(plus), Denormalize(minus), games, seed + (uint32_t)(k * games), threads);
+        for (size_t i = 0; i < x.size(); i++) {
+            x.at(i) = min(max(x.at(i) + a * (rate - 0.5) / c * delta.at(i), 0.0), 1.0);
+        }
+
+        Params current = Denormalize(x);
+        ofstream out(outPath);
+        current.save(out);
+        cout << "iteration " << k + 1 << " plus vs minus " << fixed << setprecision(3) << rate << " |";
+        current.forEach([&](const char* name, auto& value, double, double) { cout << " " << name << "=" << value; });
+        cout << "\n" << flush;
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+
+    // the tuned set against the compiled-in one on seeds the tuning never saw
+    Params tuned = Denormalize(x);
+    double rate = PlayMatch(tuned, start, games, seed + (uint32_t)(iterations * games), threads);
+    cerr.rdbuf(debug);
+    cout << "tuned vs defaults " << fixed << setprecision(3) << rate << " over " << games << " games, " << setprecision(1)
+         << (double)iterations * games / seconds * 60 << " games/min\n";
+    if (write) cout << (WriteDefaults("AI.cpp", tuned) ? "defaults written to AI.cpp\n" : "AI.cpp: no Params block\n");
+}